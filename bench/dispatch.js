@@ -0,0 +1,114 @@
+// Custo por chamada na thread principal, com o backend em memória
+// (PRINTER_ELECTRON_NODE_BACKEND=mock): o spooler não entra na conta, só a
+// conversão dos argumentos, o despacho para o pool do libuv e a resolução da
+// promise. O backend em memória só existe no binário de benchmark:
+//
+//   npm run rebuild:bench
+//   node bench/dispatch.js [opções]
+//
+//   --rate=10000      chamadas por segundo
+//   --duration=10     duração em segundos
+//   --inflight=512    máximo de chamadas pendentes
+//   --op=status       status | printers | print
+const { performance } = require('perf_hooks');
+
+process.env.PRINTER_ELECTRON_NODE_BACKEND = 'mock';
+const printer = require('../lib/printerNode');
+
+const args = Object.fromEntries(process.argv.slice(2).map((arg) => {
+  const [key, value] = arg.replace(/^--/, '').split('=');
+  return [key, value === undefined ? 'true' : value];
+}));
+
+const rate = Number(args.rate || 10000);
+const duration = Number(args.duration || 10);
+const maxInflight = Number(args.inflight || 512);
+const op = args.op || 'status';
+
+const ticket = Buffer.from('\x1b@Teste de despacho\n\n\n\x1dV\x00');
+const calls = {
+  status: () => printer.getStatusPrinter({ printerName: 'Mock-1' }),
+  printers: () => printer.getPrinters(),
+  print: () => printer.printDirect({ printerName: 'Mock-1', data: ticket }),
+};
+
+async function main() {
+  const call = calls[op];
+  if (!call) {
+    throw new Error(`op deve ser ${Object.keys(calls).join(', ')}`);
+  }
+
+  const printers = await printer.getPrinters();
+  if (!printers.some((info) => info.name === 'Mock-1')) {
+    throw new Error('backend em memória indisponível: compile com `npm run rebuild:bench`');
+  }
+
+  // Aquecimento: carrega o backend e estabiliza o JIT antes de medir.
+  for (let i = 0; i < 2000; i++) {
+    await call();
+  }
+
+  const latencies = [];
+  let inflight = 0;
+  let issued = 0;
+  let completed = 0;
+  let skipped = 0;
+  let failures = 0;
+
+  const elu = performance.eventLoopUtilization();
+  const cpu = process.cpuUsage();
+  const start = performance.now();
+
+  await new Promise((resolve) => {
+    const tick = setInterval(() => {
+      const elapsed = (performance.now() - start) / 1000;
+      if (elapsed >= duration) {
+        clearInterval(tick);
+        const wait = setInterval(() => {
+          if (inflight === 0) {
+            clearInterval(wait);
+            resolve();
+          }
+        }, 1);
+        return;
+      }
+
+      // Mantém o ritmo pedido; o que não cabe em --inflight conta como atraso.
+      const due = Math.floor(elapsed * rate) - issued - skipped;
+      for (let i = 0; i < due; i++) {
+        if (inflight >= maxInflight) {
+          skipped += due - i;
+          break;
+        }
+        const sent = performance.now();
+        inflight++;
+        issued++;
+        call()
+          .catch(() => failures++)
+          .finally(() => {
+            latencies.push(performance.now() - sent);
+            inflight--;
+            completed++;
+          });
+      }
+    }, 1);
+  });
+
+  const seconds = (performance.now() - start) / 1000;
+  const loop = performance.eventLoopUtilization(elu);
+  const usage = process.cpuUsage(cpu);
+
+  latencies.sort((a, b) => a - b);
+  const pick = (p) => latencies[Math.min(latencies.length - 1, Math.floor(latencies.length * p))] || 0;
+
+  console.log(`${op}: ${completed} chamadas em ${seconds.toFixed(2)}s (${(completed / seconds).toFixed(0)}/s de ${rate}/s pedidas)`);
+  console.log(`  latência p50 ${pick(0.5).toFixed(3)} ms  p99 ${pick(0.99).toFixed(3)} ms  máx ${pick(1).toFixed(3)} ms`);
+  console.log(`  thread principal: ${(loop.utilization * 100).toFixed(1)}% ocupada, ${((loop.active * 1000) / completed).toFixed(2)} µs por chamada`);
+  console.log(`  CPU do processo: ${((usage.user + usage.system) / completed).toFixed(2)} µs por chamada (inclui o pool do libuv)`);
+  console.log(`  descartadas por --inflight: ${skipped}  falhas: ${failures}`);
+}
+
+main().catch((error) => {
+  console.error(error);
+  process.exit(1);
+});
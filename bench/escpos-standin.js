@@ -0,0 +1,143 @@
+// Impressora ESC/POS simulada para testar getRawStatus sem hardware. Responde a
+// DLE EOT n, GS r 1 e GS a n (ASB); o resto dos bytes é descartado como dados de
+// impressão.
+//
+//   node bench/escpos-standin.js [porta|caminho] [condições] [alternar a cada ms]
+//
+//   node bench/escpos-standin.js 9100 cover-open,paper-near-end
+//   node bench/escpos-standin.js 9100 paper-end 500
+//
+// Para testar um nó de dispositivo, crie um par de pty com socat e passe um dos
+// lados para o simulador e o outro para getRawStatus:
+//
+//   socat pty,raw,echo=0,link=/tmp/escpos pty,raw,echo=0,link=/tmp/escpos-host &
+//   node bench/escpos-standin.js /tmp/escpos-host cover-open
+//   node bench/escpos-status.js /tmp/escpos
+const fs = require('fs');
+const net = require('net');
+
+const where = process.argv[2] || '9100';
+const initial = new Set((process.argv[3] || '').split(',').filter(Boolean));
+const toggleMs = Number(process.argv[4] || 0);
+
+let conditions = new Set(initial);
+const peers = new Set();
+
+function has(name) {
+  return conditions.has(name);
+}
+
+function realtime(n) {
+  let reply = 0x12;
+  switch (n) {
+    case 1:
+      if (has('drawer-pin-high')) reply |= 0x04;
+      if (has('offline')) reply |= 0x08;
+      break;
+    case 2:
+      if (has('cover-open')) reply |= 0x04;
+      if (has('paper-feed')) reply |= 0x08;
+      if (has('paper-end')) reply |= 0x20;
+      if (has('error')) reply |= 0x40;
+      break;
+    case 3:
+      if (has('mechanical-error')) reply |= 0x04;
+      if (has('cutter-error')) reply |= 0x08;
+      if (has('unrecoverable-error')) reply |= 0x20;
+      if (has('auto-recoverable-error')) reply |= 0x40;
+      break;
+    case 4:
+      if (has('paper-near-end')) reply |= 0x0c;
+      if (has('paper-end')) reply |= 0x60;
+      break;
+  }
+  return reply;
+}
+
+function paperSensor() {
+  let reply = 0;
+  if (has('paper-near-end')) reply |= 0x03;
+  if (has('paper-end')) reply |= 0x0c;
+  return reply;
+}
+
+function asbFrame() {
+  const frame = Buffer.from([0x10, 0x00, 0x00, 0x00]);
+  if (has('drawer-pin-high')) frame[0] |= 0x04;
+  if (has('offline')) frame[0] |= 0x08;
+  if (has('cover-open')) frame[0] |= 0x20;
+  if (has('paper-feed')) frame[0] |= 0x40;
+  if (has('mechanical-error')) frame[1] |= 0x04;
+  if (has('cutter-error')) frame[1] |= 0x08;
+  if (has('unrecoverable-error')) frame[1] |= 0x20;
+  if (has('auto-recoverable-error')) frame[1] |= 0x40;
+  if (has('paper-near-end')) frame[2] |= 0x03;
+  if (has('paper-end')) frame[2] |= 0x0c;
+  return frame;
+}
+
+// Interpreta o fluxo de bytes de um cliente. Comandos podem chegar partidos
+// entre leituras, por isso o resto incompleto fica guardado para a próxima.
+function createPeer(write) {
+  const peer = { asb: false, pending: Buffer.alloc(0), write };
+
+  peer.feed = (chunk) => {
+    let data = Buffer.concat([peer.pending, chunk]);
+    let i = 0;
+    while (i < data.length) {
+      const byte = data[i];
+      if ((byte === 0x10 || byte === 0x1d) && i + 2 >= data.length) {
+        break;
+      }
+      if (byte === 0x10 && data[i + 1] === 0x04) {
+        peer.write(Buffer.from([realtime(data[i + 2])]));
+        i += 3;
+      } else if (byte === 0x1d && data[i + 1] === 0x72) {
+        peer.write(Buffer.from([paperSensor()]));
+        i += 3;
+      } else if (byte === 0x1d && data[i + 1] === 0x61) {
+        peer.asb = data[i + 2] !== 0;
+        if (peer.asb) {
+          peer.write(asbFrame());
+        }
+        i += 3;
+      } else {
+        i++;
+      }
+    }
+    peer.pending = data.subarray(i);
+  };
+
+  peers.add(peer);
+  return peer;
+}
+
+if (toggleMs > 0) {
+  // Alterna entre as condições iniciais e "tudo ok" para exercitar o ASB.
+  setInterval(() => {
+    conditions = conditions.size ? new Set() : new Set(initial);
+    for (const peer of peers) {
+      if (peer.asb) {
+        peer.write(asbFrame());
+      }
+    }
+  }, toggleMs);
+}
+
+if (where.startsWith('/')) {
+  const fd = fs.openSync(where, 'r+');
+  const output = fs.createWriteStream(null, { fd, autoClose: false });
+  const peer = createPeer((data) => output.write(data));
+  fs.createReadStream(null, { fd, autoClose: false }).on('data', peer.feed);
+  console.log(`Simulador ESC/POS em ${where}`);
+} else {
+  net.createServer((socket) => {
+    socket.setNoDelay(true);
+    const peer = createPeer((data) => socket.write(data));
+    socket.on('data', peer.feed);
+    socket.on('error', () => {});
+    socket.on('close', () => peers.delete(peer));
+  }).listen(Number(where), '127.0.0.1', () => {
+    console.log(`Simulador ESC/POS em 127.0.0.1:${where}`);
+  });
+}
@@ -0,0 +1,33 @@
+// Latência de getRawStatus contra uma impressora ESC/POS (ou o simulador).
+//
+//   node bench/escpos-status.js [destino] [consultas] [asb]
+//   node bench/escpos-status.js 127.0.0.1:9100 1000 asb
+const { getRawStatus, closeRawStatus } = require('../lib/printerNode');
+
+const target = process.argv[2] || '127.0.0.1:9100';
+const queries = Number(process.argv[3] || 1000);
+const asb = process.argv[4] === 'asb';
+
+async function main() {
+  const latencies = [];
+  let last;
+
+  for (let i = 0; i < queries; i++) {
+    const start = process.hrtime.bigint();
+    last = await getRawStatus({ target, asb, timeoutMs: 500 });
+    latencies.push(Number(process.hrtime.bigint() - start) / 1e6);
+  }
+  closeRawStatus(target);
+
+  latencies.sort((a, b) => a - b);
+  const pick = (p) => latencies[Math.min(latencies.length - 1, Math.floor(latencies.length * p))];
+
+  console.log(`${target}: ${queries} consultas (${asb ? 'ASB' : 'DLE EOT'})`);
+  console.log(`  p50 ${pick(0.5).toFixed(3)} ms  p99 ${pick(0.99).toFixed(3)} ms  máx ${pick(1).toFixed(3)} ms`);
+  console.log(`  último status: flags=0x${last.flags.toString(16)} [${last.conditions.join(', ')}]`);
+}
+
+main().catch((error) => {
+  console.error(error);
+  process.exit(1);
+});
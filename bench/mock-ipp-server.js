@@ -0,0 +1,375 @@
+// Servidor IPP simulado para testes de carga com injeção de falhas.
+//
+// Atende o suficiente do protocolo para a libcups do addon: CUPS-Get-Printers,
+// CUPS-Get-Default, Get-Printer-Attributes, Create-Job, Send-Document,
+// Print-Job e Cancel-Job. Aponte o addon para ele com CUPS_SERVER:
+//
+//   node bench/mock-ipp-server.js 8631 latencyMs=50 dropRate=0.01
+//   CUPS_SERVER=127.0.0.1:8631 node bench/soak.js
+//
+// Falhas (probabilidades entre 0 e 1, sorteadas por requisição):
+//   latencyMs, jitterMs  atraso antes de responder
+//   dropRate             fecha a conexão sem responder
+//   stallRate, stallMs   aceita a requisição e fica parado por stallMs
+//   partialRate          corta o documento no meio ou a resposta pela metade
+//   errorRate, errorStatus  responde com um status IPP de erro (padrão 0x0507, busy)
+//
+// stateReasons (POST /__faults) troca o printer-state-reasons anunciado por
+// todas as filas, ex.: ["paused"] ou ["media-empty-error", "toner-low-warning"].
+//
+// Documentos enviados com compression=gzip são descompactados antes de contar;
+// se o gzip vier corrompido, responde compression-error (0x0410). Com
+// gzip=0 a fila anuncia só compression-supported=none, para exercitar o
+// caminho sem compressão.
+//
+// A configuração pode ser trocada em execução com POST /__faults (JSON), e
+// GET /__faults devolve a configuração e os contadores.
+const http = require('http');
+const zlib = require('zlib');
+
+const IPP_OP_PRINT_JOB = 0x0002;
+const IPP_OP_CREATE_JOB = 0x0005;
+const IPP_OP_SEND_DOCUMENT = 0x0006;
+const IPP_OP_CANCEL_JOB = 0x0008;
+const IPP_OP_GET_JOB_ATTRIBUTES = 0x0009;
+const IPP_OP_GET_PRINTER_ATTRIBUTES = 0x000b;
+const IPP_OP_CUPS_GET_DEFAULT = 0x4001;
+const IPP_OP_CUPS_GET_PRINTERS = 0x4002;
+
+const TAG_OPERATION = 0x01;
+const TAG_JOB = 0x02;
+const TAG_END = 0x03;
+const TAG_PRINTER = 0x04;
+const TAG_INTEGER = 0x21;
+const TAG_BOOLEAN = 0x22;
+const TAG_ENUM = 0x23;
+const TAG_TEXT = 0x41;
+const TAG_NAME = 0x42;
+const TAG_KEYWORD = 0x44;
+const TAG_URI = 0x45;
+const TAG_CHARSET = 0x47;
+const TAG_LANGUAGE = 0x48;
+const TAG_MIMETYPE = 0x49;
+
+const DEFAULT_FAULTS = {
+  latencyMs: 0,
+  jitterMs: 0,
+  dropRate: 0,
+  stallRate: 0,
+  stallMs: 30000,
+  partialRate: 0,
+  errorRate: 0,
+  errorStatus: 0x0507,
+  gzip: 1,
+  stateReasons: ['none'],
+};
+
+function parseRequest(body) {
+  const request = {
+    operation: body.readUInt16BE(2),
+    requestId: body.readUInt32BE(4),
+    attributes: {},
+    documentOffset: body.length,
+  };
+
+  let pos = 8;
+  while (pos < body.length) {
+    const tag = body[pos++];
+    if (tag === TAG_END) {
+      request.documentOffset = pos;
+      break;
+    }
+    if (tag < 0x10) {
+      continue;
+    }
+    const nameLength = body.readUInt16BE(pos);
+    const name = body.toString('utf8', pos + 2, pos + 2 + nameLength);
+    pos += 2 + nameLength;
+    const valueLength = body.readUInt16BE(pos);
+    const value = body.subarray(pos + 2, pos + 2 + valueLength);
+    pos += 2 + valueLength;
+
+    if (name && !(name in request.attributes)) {
+      request.attributes[name] =
+        tag === TAG_INTEGER || tag === TAG_ENUM ? value.readInt32BE(0) : value.toString('utf8');
+    }
+  }
+  return request;
+}
+
+class IppWriter {
+  constructor(status, requestId) {
+    this.parts = [Buffer.from([2, 0, status >> 8, status & 0xff]), uint32(requestId)];
+    this.group(TAG_OPERATION);
+    this.add(TAG_CHARSET, 'attributes-charset', 'utf-8');
+    this.add(TAG_LANGUAGE, 'attributes-natural-language', 'en');
+  }
+
+  group(tag) {
+    this.parts.push(Buffer.from([tag]));
+    return this;
+  }
+
+  add(tag, name, values) {
+    [].concat(values).forEach((value, i) => {
+      const attrName = i === 0 ? name : '';
+      let data;
+      if (tag === TAG_INTEGER || tag === TAG_ENUM) {
+        data = uint32(value);
+      } else if (tag === TAG_BOOLEAN) {
+        data = Buffer.from([value ? 1 : 0]);
+      } else {
+        data = Buffer.from(String(value), 'utf8');
+      }
+      this.parts.push(Buffer.from([tag]), uint16(Buffer.byteLength(attrName)), Buffer.from(attrName),
+        uint16(data.length), data);
+    });
+    return this;
+  }
+
+  end() {
+    this.parts.push(Buffer.from([TAG_END]));
+    return Buffer.concat(this.parts);
+  }
+}
+
+function uint16(value) {
+  const buffer = Buffer.alloc(2);
+  buffer.writeUInt16BE(value);
+  return buffer;
+}
+
+function uint32(value) {
+  const buffer = Buffer.alloc(4);
+  buffer.writeInt32BE(value);
+  return buffer;
+}
+
+function createMockIppServer(options = {}) {
+  const printers = options.printers || ['Mock-1', 'Mock-2', 'Mock-3', 'Mock-4'];
+  const faults = { ...DEFAULT_FAULTS, ...(options.faults || {}) };
+  const stats = {
+    requests: 0,
+    jobs: 0,
+    documentBytes: 0,
+    gzipDocuments: 0,
+    compressedBytes: 0,
+    dropped: 0,
+    stalled: 0,
+    partial: 0,
+    errors: 0,
+    openConnections: 0,
+  };
+  let nextJobId = 1;
+  let port = 0;
+
+  function printerAttributes(writer, name) {
+    writer.group(TAG_PRINTER)
+      .add(TAG_NAME, 'printer-name', name)
+      .add(TAG_URI, 'printer-uri-supported', `ipp://127.0.0.1:${port}/printers/${name}`)
+      .add(TAG_URI, 'device-uri', 'socket://127.0.0.1:9100')
+      .add(TAG_ENUM, 'printer-state', 3)
+      .add(TAG_KEYWORD, 'printer-state-reasons', faults.stateReasons)
+      .add(TAG_INTEGER, 'printer-type', 0x0004)
+      .add(TAG_BOOLEAN, 'printer-is-accepting-jobs', true)
+      .add(TAG_BOOLEAN, 'printer-is-shared', false)
+      .add(TAG_TEXT, 'printer-info', `${name} (simulada)`)
+      .add(TAG_TEXT, 'printer-location', 'Bancada')
+      .add(TAG_TEXT, 'printer-make-and-model', 'Mock IPP Printer')
+      .add(TAG_MIMETYPE, 'document-format-supported', ['application/octet-stream', 'image/pwg-raster', 'image/urf'])
+      .add(TAG_KEYWORD, 'compression-supported', faults.gzip ? ['none', 'gzip'] : ['none']);
+  }
+
+  function respond(request, body) {
+    const printer = (request.attributes['printer-uri'] || '').split('/printers/')[1] || printers[0];
+    const known = printers.includes(decodeURIComponent(printer));
+
+    switch (request.operation) {
+      case IPP_OP_CUPS_GET_PRINTERS: {
+        const writer = new IppWriter(0, request.requestId);
+        printers.forEach((name) => printerAttributes(writer, name));
+        return writer.end();
+      }
+      case IPP_OP_CUPS_GET_DEFAULT: {
+        const writer = new IppWriter(0, request.requestId);
+        printerAttributes(writer, printers[0]);
+        return writer.end();
+      }
+      case IPP_OP_GET_PRINTER_ATTRIBUTES: {
+        const writer = new IppWriter(known ? 0 : 0x0406, request.requestId);
+        if (known) {
+          printerAttributes(writer, decodeURIComponent(printer));
+        }
+        return writer.end();
+      }
+      case IPP_OP_CREATE_JOB:
+      case IPP_OP_PRINT_JOB: {
+        const jobId = nextJobId++;
+        stats.jobs++;
+        stats.documentBytes += body.length - request.documentOffset;
+        return new IppWriter(known ? 0 : 0x0406, request.requestId)
+          .group(TAG_JOB)
+          .add(TAG_INTEGER, 'job-id', jobId)
+          .add(TAG_URI, 'job-uri', `ipp://127.0.0.1:${port}/jobs/${jobId}`)
+          .add(TAG_ENUM, 'job-state', request.operation === IPP_OP_CREATE_JOB ? 3 : 9)
+          .end();
+      }
+      case IPP_OP_SEND_DOCUMENT: {
+        const compression = request.attributes.compression || 'none';
+        let document = body.subarray(request.documentOffset);
+        if (compression !== 'none') {
+          if (compression !== 'gzip' || !faults.gzip) {
+            return new IppWriter(0x040f, request.requestId).end();
+          }
+          try {
+            const compressed = document.length;
+            document = zlib.gunzipSync(document);
+            stats.gzipDocuments++;
+            stats.compressedBytes += compressed;
+          } catch {
+            return new IppWriter(0x0410, request.requestId).end();
+          }
+        }
+        stats.documentBytes += document.length;
+        return new IppWriter(0, request.requestId)
+          .group(TAG_JOB)
+          .add(TAG_INTEGER, 'job-id', request.attributes['job-id'] || 0)
+          .add(TAG_ENUM, 'job-state', 9)
+          .end();
+      }
+      case IPP_OP_CANCEL_JOB:
+      case IPP_OP_GET_JOB_ATTRIBUTES:
+        return new IppWriter(0, request.requestId).end();
+      default:
+        return new IppWriter(0x0501, request.requestId).end();
+    }
+  }
+
+  function handleControl(req, res) {
+    if (req.method === 'POST') {
+      let text = '';
+      req.on('data', (chunk) => (text += chunk));
+      req.on('end', () => {
+        Object.assign(faults, JSON.parse(text || '{}'));
+        res.end(JSON.stringify({ faults, stats }));
+      });
+      return;
+    }
+    res.end(JSON.stringify({ faults, stats }));
+  }
+
+  const server = http.createServer((req, res) => {
+    if (req.url === '/__faults') {
+      handleControl(req, res);
+      return;
+    }
+
+    stats.requests++;
+    const roll = Math.random();
+    const chunks = [];
+    let received = 0;
+    // Corta o upload de um documento no meio, como uma fila que cai durante o trabalho.
+    const cutUpload = Math.random() < faults.partialRate / 2;
+
+    req.on('data', (chunk) => {
+      received += chunk.length;
+      if (cutUpload && received > 512) {
+        stats.partial++;
+        req.socket.destroy();
+        return;
+      }
+      chunks.push(chunk);
+    });
+
+    req.on('end', () => {
+      const body = Buffer.concat(chunks);
+      if (body.length < 8) {
+        res.writeHead(400).end();
+        return;
+      }
+
+      const request = parseRequest(body);
+      const delay = faults.latencyMs + Math.random() * faults.jitterMs;
+
+      setTimeout(() => {
+        let threshold = faults.dropRate;
+        if (roll < threshold) {
+          stats.dropped++;
+          req.socket.destroy();
+          return;
+        }
+        if (roll < (threshold += faults.stallRate)) {
+          stats.stalled++;
+          setTimeout(() => req.socket.destroy(), faults.stallMs);
+          return;
+        }
+
+        let reply;
+        if (roll < (threshold += faults.errorRate)) {
+          stats.errors++;
+          reply = new IppWriter(faults.errorStatus, request.requestId).end();
+        } else {
+          reply = respond(request, body);
+        }
+
+        res.writeHead(200, { 'Content-Type': 'application/ipp', 'Content-Length': reply.length });
+        if (roll >= threshold && roll < threshold + faults.partialRate / 2) {
+          // Resposta cortada pela metade: cabeçalho promete mais do que chega.
+          stats.partial++;
+          res.write(reply.subarray(0, reply.length >> 1));
+          setImmediate(() => req.socket.destroy());
+          return;
+        }
+        res.end(reply);
+      }, delay);
+    });
+  });
+
+  server.on('connection', (socket) => {
+    stats.openConnections++;
+    socket.on('close', () => stats.openConnections--);
+  });
+
+  return {
+    server,
+    faults,
+    stats,
+    listen(listenPort = 0) {
+      return new Promise((resolve) => {
+        server.listen(listenPort, '127.0.0.1', () => {
+          port = server.address().port;
+          resolve(port);
+        });
+      });
+    },
+    setFaults(values) {
+      Object.assign(faults, DEFAULT_FAULTS, values);
+    },
+    close() {
+      server.closeAllConnections?.();
+      return new Promise((resolve) => server.close(resolve));
+    },
+  };
+}
+
+module.exports = { createMockIppServer, DEFAULT_FAULTS };
+
+if (require.main === module) {
+  const listenPort = Number(process.argv[2] || 8631);
+  const faults = {};
+  for (const arg of process.argv.slice(3)) {
+    const [key, value] = arg.split('=');
+    faults[key] = Number(value);
+  }
+
+  const mock = createMockIppServer({ faults });
+  mock.listen(listenPort).then((port) => {
+    if (process.send) {
+      // Iniciado pelo bench/soak.js com fork().
+      process.send({ port });
+      return;
+    }
+    console.log(`Servidor IPP simulado em 127.0.0.1:${port} (CUPS_SERVER=127.0.0.1:${port})`);
+    console.log(`Falhas: ${JSON.stringify(mock.faults)}`);
+  });
+}
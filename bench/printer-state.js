@@ -0,0 +1,59 @@
+// Confere a severidade que o backend CUPS dá a cada printer-state-reasons,
+// usando o bench/mock-ipp-server.js. As condições que também existem no
+// Windows precisam sair com a mesma severidade que o mapeamento de
+// PRINTER_STATUS_* dá a elas (ver windows_printer.cpp), para que um
+// stateSeverity >= 3 signifique o mesmo em todos os sistemas.
+//
+//   node bench/printer-state.js
+const { createMockIppServer } = require('./mock-ipp-server');
+
+const REPORT = 1;
+const WARNING = 2;
+const ERROR = 3;
+
+const CASES = [
+  { reasons: ['none'], severity: 0, names: [] },
+  // PRINTER_STATUS_PAUSED e PRINTER_STATUS_PENDING_DELETION no Windows.
+  { reasons: ['paused'], severity: WARNING, names: ['paused'] },
+  { reasons: ['moving-to-paused'], severity: WARNING, names: ['moving-to-paused'] },
+  { reasons: ['shutdown'], severity: WARNING, names: ['shutdown'] },
+  { reasons: ['paused-error'], severity: ERROR, names: ['paused'] },
+  { reasons: ['media-empty'], severity: ERROR, names: ['media-empty'] },
+  { reasons: ['toner-low-warning'], severity: WARNING, names: ['toner-low'] },
+  { reasons: ['cups-waiting-for-job-completed'], severity: REPORT, names: ['other'] },
+  { reasons: ['paused', 'media-jam-error'], severity: ERROR, names: ['paused', 'media-jam'] },
+];
+
+async function main() {
+  const mock = createMockIppServer();
+  const port = await mock.listen(0);
+  // A libcups lê CUPS_SERVER no primeiro uso, que agora é sob demanda.
+  process.env.CUPS_SERVER = `127.0.0.1:${port}`;
+  const printer = require('../lib/printerNode');
+
+  let failures = 0;
+  for (const expected of CASES) {
+    mock.setFaults({ stateReasons: expected.reasons });
+    const info = await printer.getStatusPrinter({ printerName: 'Mock-1' });
+    const names = printer.decodeStateReasons(info.stateReasons);
+    const ok = info.stateSeverity === expected.severity &&
+      JSON.stringify(names) === JSON.stringify(expected.names);
+    if (!ok) {
+      failures++;
+    }
+    console.log(`${ok ? 'ok  ' : 'FAIL'} ${expected.reasons.join(',').padEnd(36)} ` +
+      `severidade ${info.stateSeverity} (esperada ${expected.severity})  [${names.join(', ')}]`);
+  }
+
+  await mock.close();
+  if (failures) {
+    console.log(`\n${failures} de ${CASES.length} casos com severidade diferente da esperada.`);
+    process.exit(1);
+  }
+  console.log(`\n${CASES.length} casos ok.`);
+}
+
+main().catch((error) => {
+  console.error(error);
+  process.exit(1);
+});
@@ -0,0 +1,45 @@
+// Páginas por segundo do encoder PWG/URF nativo.
+//
+//   node bench/raster.js [páginas] [pwg|urf] [threads]
+//   PRINTER_NAME="IPP Everywhere" node bench/raster.js 10 pwg   (também imprime)
+const path = require('path');
+const printer = require(path.join(__dirname, '..', 'lib'));
+
+const pageCount = Number(process.argv[2] || 20);
+const format = process.argv[3] || 'pwg';
+const threads = process.argv[4] ? Number(process.argv[4]) : undefined;
+
+// A4 em 300 dpi, RGBA, com faixas de "texto" sobre fundo branco.
+function makePage(width, height) {
+  const data = Buffer.alloc(width * height * 4, 255);
+  for (let y = 0; y < height; y++) {
+    if (y % 60 >= 40) continue;
+    for (let x = 150; x < width - 150; x++) {
+      if ((x * 7 + y * 13) % 11 < 4) {
+        const i = (y * width + x) * 4;
+        data[i] = data[i + 1] = data[i + 2] = 0;
+      }
+    }
+  }
+  return { width, height, data, channels: 4 };
+}
+
+(async () => {
+  const page = makePage(2480, 3508);
+  const pages = Array.from({ length: pageCount }, () => page);
+
+  const start = process.hrtime.bigint();
+  const raster = await printer.encodeRaster({ pages, format, resolution: 300, threads });
+  const seconds = Number(process.hrtime.bigint() - start) / 1e9;
+  console.log(`${pageCount} páginas ${format} em ${seconds.toFixed(2)}s: ${(pageCount / seconds).toFixed(2)} páginas/s, ${(raster.length / 1048576).toFixed(1)} MiB`);
+
+  if (process.env.PRINTER_NAME) {
+    const printStart = process.hrtime.bigint();
+    const result = await printer.printRaster({ printerName: process.env.PRINTER_NAME, pages, format, resolution: 300, threads });
+    const printSeconds = Number(process.hrtime.bigint() - printStart) / 1e9;
+    console.log(`printRaster: ${result.status} em ${printSeconds.toFixed(2)}s: ${(pageCount / printSeconds).toFixed(2)} páginas/s`);
+  }
+})().catch((error) => {
+  console.error(error);
+  process.exitCode = 1;
+});
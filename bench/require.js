@@ -0,0 +1,35 @@
+// Tempo de require() do addon em processos novos e se a libcups já foi
+// carregada logo depois dele. Rode antes e depois de uma mudança para comparar.
+//
+//   node bench/require.js [execuções]
+const { execFileSync } = require('child_process');
+const path = require('path');
+
+const runs = Number(process.argv[2] || 20);
+const entry = path.join(__dirname, '..', 'lib', 'printerNode.js');
+
+const probe = `
+const fs = require('fs');
+const start = process.hrtime.bigint();
+require(${JSON.stringify(entry)});
+const ms = Number(process.hrtime.bigint() - start) / 1e6;
+let cups = null;
+try { cups = /libcups/.test(fs.readFileSync('/proc/self/maps', 'utf8')); } catch {}
+process.stdout.write(JSON.stringify({ ms, cups }));
+`;
+
+const samples = [];
+let cupsLoaded = null;
+for (let i = 0; i < runs; i++) {
+  const result = JSON.parse(execFileSync(process.execPath, ['-e', probe]).toString());
+  samples.push(result.ms);
+  cupsLoaded = result.cups;
+}
+
+samples.sort((a, b) => a - b);
+const median = samples[Math.floor(samples.length / 2)];
+
+console.log(`require(): mediana ${median.toFixed(2)} ms, mín ${samples[0].toFixed(2)} ms, máx ${samples[samples.length - 1].toFixed(2)} ms (${runs} processos)`);
+if (cupsLoaded !== null) {
+  console.log(`libcups carregada após o require: ${cupsLoaded ? 'sim' : 'não'}`);
+}
@@ -0,0 +1,311 @@
+// Teste de carga e de longa duração com injeção de falhas.
+//
+// Sobe o bench/mock-ipp-server.js em um processo separado, aponta o addon para
+// ele (CUPS_SERVER) e mantém N chamadores concorrentes de printDirect e
+// getStatusPrinter enquanto o servidor alterna entre fases de falha. A cada
+// intervalo imprime throughput, latência de cauda, erros, RSS, descritores
+// abertos e workers nativos vivos; no fim, confere se algo vazou e se houve
+// erro nas fases sem falha injetada (healthy e drain).
+//
+//   node bench/soak.js [opções]
+//
+//   --duration=600     duração total em segundos (ex.: 14400 para 4 horas)
+//   --phase=60         duração de cada fase de falha em segundos
+//   --interval=10      intervalo entre relatórios em segundos
+//   --concurrency=32   chamadores simultâneos
+//   --print=0.7        fração das chamadas que são printDirect
+//   --payload=2048     bytes por trabalho
+//   --timeout=15000    timeoutMs de cada printDirect
+//   --phases=healthy,slow,drop,partial,error,stall
+//   --json=soak.ndjson grava cada amostra em JSON, uma por linha
+//
+// Com CUPS_SERVER já definido, usa esse servidor em vez de subir o simulado
+// (as fases são aplicadas via POST /__faults se ele for o simulado).
+const { fork } = require('child_process');
+const fs = require('fs');
+const http = require('http');
+const path = require('path');
+
+const args = Object.fromEntries(process.argv.slice(2).map((arg) => {
+  const [key, value] = arg.replace(/^--/, '').split('=');
+  return [key, value === undefined ? 'true' : value];
+}));
+
+const config = {
+  duration: Number(args.duration || 600),
+  phase: Number(args.phase || 60),
+  interval: Number(args.interval || 10),
+  concurrency: Number(args.concurrency || 32),
+  printRatio: Number(args.print || 0.7),
+  payload: Number(args.payload || 2048),
+  timeout: Number(args.timeout || 15000),
+  phases: (args.phases || 'healthy,slow,drop,partial,error,stall').split(','),
+  json: args.json,
+};
+
+const PHASES = {
+  healthy: {},
+  slow: { latencyMs: 150, jitterMs: 150 },
+  drop: { dropRate: 0.05 },
+  partial: { partialRate: 0.05 },
+  error: { errorRate: 0.1 },
+  stall: { stallRate: 0.02, stallMs: 5000 },
+};
+
+// Fases em que o servidor não injeta falhas: qualquer erro nelas reprova o teste.
+const CLEAN_PHASES = new Set(['healthy', 'drain']);
+
+const PRINTERS = ['Mock-1', 'Mock-2', 'Mock-3', 'Mock-4'];
+
+// Histograma com baldes logarítmicos (5% de resolução), para manter a cauda
+// de horas de execução sem guardar cada amostra.
+class Histogram {
+  constructor() {
+    this.buckets = new Map();
+    this.count = 0;
+    this.max = 0;
+  }
+
+  record(ms) {
+    const bucket = Math.max(0, Math.ceil(Math.log(Math.max(ms, 0.01) / 0.01) / Math.log(1.05)));
+    this.buckets.set(bucket, (this.buckets.get(bucket) || 0) + 1);
+    this.count++;
+    this.max = Math.max(this.max, ms);
+  }
+
+  percentile(p) {
+    if (!this.count) {
+      return 0;
+    }
+    const target = Math.ceil(this.count * p);
+    let seen = 0;
+    for (const bucket of [...this.buckets.keys()].sort((a, b) => a - b)) {
+      seen += this.buckets.get(bucket);
+      if (seen >= target) {
+        return Math.min(0.01 * Math.pow(1.05, bucket), this.max);
+      }
+    }
+    return this.max;
+  }
+}
+
+function newWindow() {
+  return {
+    print: new Histogram(),
+    status: new Histogram(),
+    errors: {},
+  };
+}
+
+function openFds() {
+  for (const dir of ['/proc/self/fd', '/dev/fd']) {
+    try {
+      return fs.readdirSync(dir).length;
+    } catch {
+      // Tenta o próximo.
+    }
+  }
+  return -1;
+}
+
+function setFaults(port, faults) {
+  return new Promise((resolve) => {
+    const body = JSON.stringify({
+      latencyMs: 0, jitterMs: 0, dropRate: 0, stallRate: 0, partialRate: 0, errorRate: 0,
+      ...faults,
+    });
+    const req = http.request({ host: '127.0.0.1', port, path: '/__faults', method: 'POST' }, (res) => {
+      res.resume();
+      res.on('end', resolve);
+    });
+    req.on('error', resolve);
+    req.end(body);
+  });
+}
+
+function startMock() {
+  return new Promise((resolve, reject) => {
+    const child = fork(path.join(__dirname, 'mock-ipp-server.js'), ['0'], { stdio: 'inherit' });
+    child.once('message', ({ port }) => resolve({ child, port }));
+    child.once('error', reject);
+  });
+}
+
+function classify(error) {
+  if (error?.code) {
+    return error.code;
+  }
+  const message = String(error?.message || error);
+  return message.length > 40 ? `${message.slice(0, 40)}...` : message;
+}
+
+async function main() {
+  let mock = null;
+  let port;
+  if (process.env.CUPS_SERVER) {
+    port = Number(process.env.CUPS_SERVER.split(':')[1] || 631);
+  } else {
+    mock = await startMock();
+    port = mock.port;
+    // A libcups lê CUPS_SERVER no primeiro uso, que agora é sob demanda.
+    process.env.CUPS_SERVER = `127.0.0.1:${port}`;
+  }
+
+  const printer = require('../lib/printerNode');
+  const payload = Buffer.alloc(config.payload, 0x41);
+  const output = config.json ? fs.createWriteStream(config.json) : null;
+
+  let window = newWindow();
+  const total = newWindow();
+  let running = true;
+  let completed = 0;
+  let phaseName = config.phases[0];
+  // Trocado a cada mudança de fase. Um erro só conta contra uma fase limpa se
+  // a chamada começou e terminou nela, para não culpar a fase seguinte por
+  // chamadas que pegaram a falha anterior.
+  let phase = { name: phaseName };
+  const cleanErrors = {};
+
+  async function caller(id) {
+    let i = 0;
+    while (running) {
+      const target = PRINTERS[(id + i++) % PRINTERS.length];
+      const isPrint = Math.random() < config.printRatio;
+      const kind = isPrint ? 'print' : 'status';
+      const start = process.hrtime.bigint();
+      const startPhase = phase;
+      try {
+        if (isPrint) {
+          const result = await printer.printDirect({ printerName: target, data: payload, timeoutMs: config.timeout });
+          if (result.status !== 'success') {
+            throw new Error('status failed');
+          }
+        } else {
+          await printer.getStatusPrinter({ printerName: target });
+        }
+      } catch (error) {
+        const key = `${kind}:${classify(error)}`;
+        window.errors[key] = (window.errors[key] || 0) + 1;
+        total.errors[key] = (total.errors[key] || 0) + 1;
+        if (startPhase === phase && CLEAN_PHASES.has(phase.name)) {
+          const cleanKey = `${phase.name}:${key}`;
+          cleanErrors[cleanKey] = (cleanErrors[cleanKey] || 0) + 1;
+        }
+      }
+      const ms = Number(process.hrtime.bigint() - start) / 1e6;
+      window[kind].record(ms);
+      total[kind].record(ms);
+      completed++;
+    }
+  }
+
+  const started = Date.now();
+  const samples = [];
+  let baseline = null;
+
+  function report() {
+    const native = printer.getNativeStats();
+    const sample = {
+      t: Math.round((Date.now() - started) / 1000),
+      phase: phaseName,
+      opsPerSec: (window.print.count + window.status.count) / config.interval,
+      print: { count: window.print.count, p50: window.print.percentile(0.5), p99: window.print.percentile(0.99), max: window.print.max },
+      status: { count: window.status.count, p50: window.status.percentile(0.5), p99: window.status.percentile(0.99), max: window.status.max },
+      errors: window.errors,
+      rssMb: process.memoryUsage().rss / 1048576,
+      fds: openFds(),
+      liveWorkers: native.liveWorkers,
+      queuedJobs: native.queuedJobs,
+    };
+    samples.push(sample);
+    if (!baseline) {
+      baseline = sample;
+    }
+    output?.write(JSON.stringify(sample) + '\n');
+
+    const errors = Object.entries(sample.errors).map(([key, count]) => `${key}=${count}`).join(' ') || '-';
+    console.log(
+      `[${String(sample.t).padStart(6)}s ${sample.phase.padEnd(7)}] ` +
+      `${sample.opsPerSec.toFixed(0).padStart(6)} op/s  ` +
+      `print p50 ${sample.print.p50.toFixed(1)} p99 ${sample.print.p99.toFixed(1)} ms  ` +
+      `status p50 ${sample.status.p50.toFixed(1)} p99 ${sample.status.p99.toFixed(1)} ms  ` +
+      `rss ${sample.rssMb.toFixed(1)} MB  fds ${sample.fds}  workers ${sample.liveWorkers}  fila ${sample.queuedJobs}  erros ${errors}`);
+    window = newWindow();
+  }
+
+  console.log(`Soak: ${config.duration}s, ${config.concurrency} chamadores, fases ${config.phases.join(' → ')} (${config.phase}s cada), CUPS_SERVER=${process.env.CUPS_SERVER}`);
+
+  const reporter = setInterval(report, config.interval * 1000);
+  let phaseIndex = 0;
+  await setFaults(port, PHASES[phaseName]);
+  // Durante a troca as chamadas não pertencem a nenhuma fase.
+  async function switchPhase(name, faults) {
+    phaseName = name;
+    phase = { name: 'switching' };
+    await setFaults(port, faults);
+    phase = { name };
+  }
+  const phaser = setInterval(() => {
+    const name = config.phases[++phaseIndex % config.phases.length];
+    switchPhase(name, PHASES[name] || {});
+  }, config.phase * 1000);
+
+  const callers = Array.from({ length: config.concurrency }, (_, id) => caller(id));
+  await new Promise((resolve) => setTimeout(resolve, config.duration * 1000));
+
+  // Fim da carga: servidor saudável de novo por mais um intervalo, que não
+  // pode ter erros; depois espera as chamadas em voo e a fila nativa
+  // esvaziarem antes de procurar vazamentos.
+  clearInterval(phaser);
+  await switchPhase('drain', {});
+  await new Promise((resolve) => setTimeout(resolve, config.interval * 1000));
+  running = false;
+  await Promise.all(callers);
+  const drainDeadline = Date.now() + 30000;
+  while (printer.getNativeStats().liveWorkers > 0 && Date.now() < drainDeadline) {
+    await new Promise((resolve) => setTimeout(resolve, 100));
+  }
+  clearInterval(reporter);
+  report();
+
+  const last = samples[samples.length - 1];
+  const hours = Math.max((last.t - baseline.t) / 3600, 1 / 3600);
+  const rssSlope = (last.rssMb - baseline.rssMb) / hours;
+  const fdGrowth = last.fds - baseline.fds;
+  const seconds = (Date.now() - started) / 1000;
+
+  console.log('\nResumo');
+  console.log(`  chamadas: ${completed} (${(completed / seconds).toFixed(0)} op/s)`);
+  console.log(`  printDirect: p50 ${total.print.percentile(0.5).toFixed(1)} ms  p99 ${total.print.percentile(0.99).toFixed(1)} ms  p99.9 ${total.print.percentile(0.999).toFixed(1)} ms  máx ${total.print.max.toFixed(1)} ms`);
+  console.log(`  getStatusPrinter: p50 ${total.status.percentile(0.5).toFixed(1)} ms  p99 ${total.status.percentile(0.99).toFixed(1)} ms  p99.9 ${total.status.percentile(0.999).toFixed(1)} ms  máx ${total.status.max.toFixed(1)} ms`);
+  console.log(`  erros: ${JSON.stringify(total.errors)}`);
+  console.log(`  erros em fases sem falha: ${JSON.stringify(cleanErrors)}`);
+  console.log(`  workers vivos no fim: ${last.liveWorkers}  trabalhos na fila: ${last.queuedJobs}`);
+  console.log(`  descritores: ${baseline.fds} → ${last.fds}  RSS: ${baseline.rssMb.toFixed(1)} → ${last.rssMb.toFixed(1)} MB (${rssSlope.toFixed(1)} MB/h)`);
+
+  const leaks = [];
+  if (last.liveWorkers > 0) leaks.push(`${last.liveWorkers} workers nativos não terminaram`);
+  if (last.queuedJobs > 0) leaks.push(`${last.queuedJobs} trabalhos presos na fila`);
+  if (fdGrowth > 16) leaks.push(`${fdGrowth} descritores a mais que no início`);
+
+  await new Promise((resolve) => (output ? output.end(resolve) : resolve()));
+  mock?.child.kill();
+
+  const cleanErrorCount = Object.values(cleanErrors).reduce((sum, count) => sum + count, 0);
+  if (leaks.length) {
+    console.log(`\nVazamentos: ${leaks.join('; ')}`);
+  }
+  if (cleanErrorCount) {
+    console.log(`\n${cleanErrorCount} erros em fases sem falha injetada: ${Object.keys(cleanErrors).join(', ')}`);
+  }
+  if (leaks.length || cleanErrorCount) {
+    process.exit(1);
+  }
+  console.log('\nSem vazamentos nem erros nas fases sem falha.');
+  process.exit(0);
+}
+
+main().catch((error) => {
+  console.error(error);
+  process.exit(1);
+});
@@ -0,0 +1,59 @@
+// Throughput de getStatusPrinter/printDirect distribuído por N worker_threads.
+//
+//   PRINTER_NAME="Minha Impressora" node bench/workers.js [workers] [chamadas por worker] [status|print]
+const { Worker, isMainThread, parentPort, workerData } = require('worker_threads');
+const path = require('path');
+
+const printerName = process.env.PRINTER_NAME;
+
+if (isMainThread) {
+  const workers = Number(process.argv[2] || 4);
+  const calls = Number(process.argv[3] || 200);
+  const mode = process.argv[4] || 'status';
+
+  if (!printerName) {
+    console.error('Defina PRINTER_NAME com o nome da impressora de teste.');
+    process.exit(1);
+  }
+
+  const start = process.hrtime.bigint();
+  let finished = 0;
+  let failures = 0;
+
+  for (let i = 0; i < workers; i++) {
+    const worker = new Worker(__filename, { workerData: { calls, mode } });
+    worker.on('message', (result) => {
+      failures += result.failures;
+      if (++finished === workers) {
+        const seconds = Number(process.hrtime.bigint() - start) / 1e9;
+        const total = workers * calls;
+        console.log(`${workers} workers x ${calls} chamadas (${mode})`);
+        console.log(`${total} chamadas em ${seconds.toFixed(2)}s: ${(total / seconds).toFixed(1)} ops/s, ${failures} falhas`);
+      }
+    });
+    worker.on('error', (error) => {
+      console.error(error);
+      process.exitCode = 1;
+    });
+  }
+} else {
+  const printer = require(path.join(__dirname, '..', 'lib'));
+  const { calls, mode } = workerData;
+  const ticket = Buffer.from('\x1b@Teste de throughput\n\n\n\x1dV\x00');
+
+  (async () => {
+    let failures = 0;
+    for (let i = 0; i < calls; i++) {
+      try {
+        if (mode === 'print') {
+          await printer.printDirect({ printerName, data: ticket, dataType: 'RAW' });
+        } else {
+          await printer.getStatusPrinter({ printerName });
+        }
+      } catch (error) {
+        failures++;
+      }
+    }
+    parentPort.postMessage({ failures });
+  })();
+}
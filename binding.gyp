@@ -1,11 +1,21 @@
 {
+  "variables": {
+    "mock_backend%": "false"
+  },
   "targets": [
     {
       "target_name": "printer_electron_node",
       "sources": [
         "src/main.cpp",
         "src/print.cpp",
-        "src/printer_factory.cpp"
+        "src/printer_factory.cpp",
+        "src/printer_cache.cpp",
+        "src/addon_context.cpp",
+        "src/raster_encoder.cpp",
+        "src/print_queue.cpp",
+        "src/escpos_status.cpp",
+        "src/printer_state.cpp",
+        "src/trace.cpp"
       ],
       "include_dirs": [
         "<!@(node -p \"require('node-addon-api').include\")"
@@ -15,18 +25,24 @@
       ],
       "defines": [ "NAPI_CPP_EXCEPTIONS" ],
       "conditions": [
+        ['mock_backend=="true"', {
+          "sources": ["src/mock_printer.cpp"],
+          "defines": ["PRINTER_ELECTRON_NODE_MOCK"]
+        }],
         ['OS=="win"', {
           "sources": ["src/windows_printer.cpp"],
-          "libraries": ["winspool.lib"],
+          "libraries": ["winspool.lib", "delayimp.lib"],
           "msvs_settings": {
             "VCCLCompilerTool": {
               "ExceptionHandling": 1
+            },
+            "VCLinkerTool": {
+              "DelayLoadDLLs": ["winspool.drv"]
             }
           }
         }],
         ['OS=="mac"', {
-          "sources": ["src/mac_printer.cpp"],
-          "libraries": ["-lcups"],
+          "sources": ["src/mac_printer.cpp", "src/cups_loader.cpp", "src/gzip_stream.cpp"],
           "include_dirs": [
             "/usr/include/cups"
           ],
@@ -38,8 +54,8 @@
           }
         }],
         ['OS=="linux"', {
-          "sources": ["src/linux_printer.cpp"],
-          "libraries": ["-lcups"],
+          "sources": ["src/linux_printer.cpp", "src/cups_loader.cpp", "src/gzip_stream.cpp"],
+          "libraries": ["-ldl"],
           "include_dirs": [
             "/usr/include/cups"
           ],
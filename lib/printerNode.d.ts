@@ -1,12 +1,34 @@
+import { EventEmitter } from 'events';
+export declare const printerEvents: EventEmitter<[never]>;
+export declare const PrinterStateReason: Readonly<Record<string, number>>;
+export type JobPriority = 'high' | 'normal' | 'bulk';
+export type DocumentCompression = 'gzip' | 'none';
 export interface PrintOptions {
     printerName: string;
     data: string | Buffer;
     dataType?: 'RAW' | 'TEXT' | 'COMMAND' | 'AUTO' | undefined;
+    priority?: JobPriority;
+    timeoutMs?: number;
+    compression?: DocumentCompression;
 }
+export interface PrintManyOptions extends Omit<PrintOptions, 'printerName'> {
+    printerNames: string[];
+}
+export interface PrintManyResult {
+    name: string;
+    status: 'success' | 'failed' | 'timeout';
+    error?: Error;
+}
+export type PrinterStateReasonName = 'other' | 'offline' | 'paused' | 'moving-to-paused' | 'shutdown' | 'connecting-to-device' | 'timed-out' | 'stopping' | 'stopped-partly' | 'media-needed' | 'media-jam' | 'media-low' | 'media-empty' | 'input-tray-missing' | 'output-tray-missing' | 'output-area-almost-full' | 'output-area-full' | 'toner-low' | 'toner-empty' | 'marker-supply-low' | 'marker-supply-empty' | 'marker-waste-almost-full' | 'marker-waste-full' | 'cover-open' | 'door-open' | 'spool-area-full' | 'resource-unavailable' | 'fuser-error' | 'warming-up' | 'user-intervention' | 'missing-filter' | 'error';
+export type PrinterStateSeverity = 0 | 1 | 2 | 3;
 export interface Printer {
     name: string;
     isDefault: boolean;
     status: string;
+    stateReasons: number;
+    stateSeverity: PrinterStateSeverity;
+    reasons?: PrinterStateReasonName[];
+    stale?: boolean;
     details: {
         location?: string;
         comment?: string;
@@ -19,15 +41,96 @@ export interface PrintDirectOptions {
     printerName: string;
     data: string | Buffer;
     dataType?: 'RAW' | 'TEXT' | 'COMMAND' | 'AUTO' | undefined;
+    priority?: JobPriority;
+    timeoutMs?: number;
+    compression?: DocumentCompression;
 }
 export interface GetStatusPrinterOptions {
     printerName: string;
+    decodeReasons?: boolean;
+}
+export interface GetDefaultPrinterOptions {
+    decodeReasons?: boolean;
+}
+export interface CoalescingOptions {
+    printerName: string;
+    windowMs: number;
+    maxBytes?: number;
+}
+export interface QueueLimitsOptions {
+    printerName: string;
+    maxQueuedJobs?: number;
+    maxQueuedBytes?: number;
+    agingMs?: number;
+}
+export interface QueueInfo {
+    name: string;
+    depth: number;
+    bytes: number;
+    oldestAgeMs: number;
+    printing: boolean;
+    rejected: number;
+}
+export interface NativeStats {
+    liveWorkers: number;
+    queues: number;
+    queuedJobs: number;
+    queuedBytes: number;
+}
+export interface GetPrintersOptions {
+    cachePath?: string;
+    decodeReasons?: boolean;
+}
+export interface RasterPage {
+    width: number;
+    height: number;
+    data: Buffer;
+    channels?: 1 | 3 | 4;
+}
+export interface EncodeRasterOptions {
+    pages: RasterPage[];
+    format?: 'pwg' | 'urf';
+    resolution?: number;
+    grayscale?: boolean;
+    threads?: number;
+}
+export interface PrintRasterOptions extends EncodeRasterOptions {
+    printerName: string;
+    compression?: DocumentCompression;
+}
+export interface RawStatusOptions {
+    target: string;
+    timeoutMs?: number;
+    asb?: boolean;
+}
+export type RawStatusCondition = 'offline' | 'cover-open' | 'paper-feed' | 'paper-near-end' | 'paper-end' | 'stopped-paper-end' | 'error' | 'mechanical-error' | 'cutter-error' | 'unrecoverable-error' | 'auto-recoverable-error' | 'drawer-pin-high' | 'waiting-online' | 'no-response';
+export interface RawStatus {
+    target: string;
+    online: boolean;
+    flags: number;
+    conditions: RawStatusCondition[];
+    asb: boolean;
+    ageMs: number;
+    latencyMs: number;
 }
 export interface PrintDirectOutput {
     name: string;
     status: 'success' | 'failed';
 }
 export declare function printDirect(printOptions: PrintOptions): Promise<PrintDirectOutput>;
+export declare function printMany(printOptions: PrintManyOptions): Promise<PrintManyResult[]>;
+export declare function setQueueLimits(options: QueueLimitsOptions): void;
+export declare function getQueueInfo(printerName: string): QueueInfo;
+export declare function setCoalescing(options: CoalescingOptions): void;
+export declare function printRaster(printOptions: PrintRasterOptions): Promise<PrintDirectOutput>;
+export declare function encodeRaster(options: EncodeRasterOptions): Promise<Buffer>;
+export declare function getRawStatus(options: RawStatusOptions): Promise<RawStatus>;
+export declare function closeRawStatus(target: string): boolean;
 export declare function getStatusPrinter(printOptions: GetStatusPrinterOptions): Promise<Printer>;
-export declare function getPrinters(): Promise<Printer[]>;
-export declare function getDefaultPrinter(): Promise<Printer>;
+export declare function getPrinters(options?: GetPrintersOptions): Promise<Printer[]>;
+export declare function getDefaultPrinter(options?: GetDefaultPrinterOptions): Promise<Printer>;
+export declare function decodeStateReasons(stateReasons: number): PrinterStateReasonName[];
+export declare function isPrintingAvailable(): boolean;
+export declare function getNativeStats(): NativeStats;
+export declare function setTracing(enabled: boolean): void;
+export declare function dumpTrace(path?: string): string;
@@ -3,20 +3,133 @@ var __importDefault = (this && this.__importDefault) || function (mod) {
     return (mod && mod.__esModule) ? mod : { "default": mod };
 };
 Object.defineProperty(exports, "__esModule", { value: true });
+exports.PrinterStateReason = exports.printerEvents = void 0;
 exports.printDirect = printDirect;
+exports.printMany = printMany;
+exports.setQueueLimits = setQueueLimits;
+exports.getQueueInfo = getQueueInfo;
+exports.setCoalescing = setCoalescing;
+exports.printRaster = printRaster;
+exports.encodeRaster = encodeRaster;
+exports.getRawStatus = getRawStatus;
+exports.closeRawStatus = closeRawStatus;
 exports.getStatusPrinter = getStatusPrinter;
 exports.getPrinters = getPrinters;
 exports.getDefaultPrinter = getDefaultPrinter;
+exports.decodeStateReasons = decodeStateReasons;
+exports.isPrintingAvailable = isPrintingAvailable;
+exports.getNativeStats = getNativeStats;
+exports.setTracing = setTracing;
+exports.dumpTrace = dumpTrace;
 const bindings_1 = __importDefault(require("bindings"));
+const events_1 = require("events");
+const fs_1 = require("fs");
 const printerNode = (0, bindings_1.default)('printer_electron_node');
+exports.printerEvents = new events_1.EventEmitter();
+// Bits de stateReasons (ex.: PrinterStateReason.MEDIA_EMPTY), gerados pelo addon.
+exports.PrinterStateReason = printerNode.stateReasonFlags;
+const saturatedQueues = new Set();
 async function printDirect(printOptions) {
     const input = {
         ...printOptions,
         printerName: normalizeString(printOptions.printerName)
     };
-    const printer = await printerNode.printDirect(input);
+    return trackQueue(input.printerName, withTimeout(printerNode.printDirect(input), input.printerName, input.timeoutMs));
+}
+async function printMany(printOptions) {
+    const { printerNames, ...rest } = printOptions;
+    const names = printerNames.map(normalizeString);
+    // Um único payload nativo para todas as impressoras; cada uma tem a sua
+    // fila e o seu prazo, então uma estação lenta não segura as outras.
+    const jobs = printerNode.printDirect({ ...rest, printerName: names });
+    return Promise.all(jobs.map(async (job, i) => {
+        try {
+            return await trackQueue(names[i], withTimeout(job, names[i], rest.timeoutMs));
+        }
+        catch (error) {
+            return {
+                name: names[i],
+                status: error?.code === 'ETIMEDOUT' ? 'timeout' : 'failed',
+                error
+            };
+        }
+    }));
+}
+async function trackQueue(printerName, job) {
+    try {
+        return await job;
+    }
+    catch (error) {
+        if (error?.code === 'EQUEUEFULL') {
+            saturatedQueues.add(printerName);
+        }
+        throw error;
+    }
+    finally {
+        checkDrain(printerName);
+    }
+}
+function withTimeout(job, printerName, timeoutMs) {
+    if (!timeoutMs || timeoutMs <= 0) {
+        return job;
+    }
+    let timer;
+    const timeout = new Promise((_, reject) => {
+        timer = setTimeout(() => {
+            const error = new Error(`Print job for '${printerName}' timed out after ${timeoutMs} ms`);
+            error.code = 'ETIMEDOUT';
+            reject(error);
+        }, timeoutMs);
+    });
+    // O trabalho continua na fila nativa; se ainda não tiver sido enviado quando
+    // o prazo vencer, é descartado lá sem imprimir.
+    job.catch(() => { });
+    return Promise.race([job, timeout]).finally(() => clearTimeout(timer));
+}
+function checkDrain(printerName) {
+    if (!saturatedQueues.has(printerName)) {
+        return;
+    }
+    const queue = printerNode.getQueueInfo({ printerName });
+    if (queue.depth === 0) {
+        saturatedQueues.delete(printerName);
+        exports.printerEvents.emit('drain', printerName);
+    }
+}
+function setQueueLimits(options) {
+    printerNode.setQueueLimits({
+        ...options,
+        printerName: normalizeString(options.printerName)
+    });
+}
+function getQueueInfo(printerName) {
+    return printerNode.getQueueInfo({ printerName: normalizeString(printerName) });
+}
+function setCoalescing(options) {
+    printerNode.setCoalescing({
+        ...options,
+        printerName: normalizeString(options.printerName)
+    });
+}
+async function printRaster(printOptions) {
+    const input = {
+        ...printOptions,
+        printerName: normalizeString(printOptions.printerName)
+    };
+    const printer = await printerNode.printRaster(input);
     return printer;
 }
+async function encodeRaster(options) {
+    const raster = await printerNode.encodeRaster(options);
+    return raster;
+}
+async function getRawStatus(options) {
+    const status = await printerNode.getRawStatus(options);
+    return status;
+}
+function closeRawStatus(target) {
+    return printerNode.closeRawStatus({ target });
+}
 async function getStatusPrinter(printOptions) {
     const input = {
         ...printOptions,
@@ -25,14 +138,61 @@ async function getStatusPrinter(printOptions) {
     const printer = await printerNode.getStatusPrinter(input);
     return printer;
 }
-async function getPrinters() {
-    const printers = await printerNode.getPrinters();
-    return printers;
+const revalidating = new Set();
+async function getPrinters(options) {
+    const cachePath = options?.cachePath;
+    const decodeReasons = options?.decodeReasons === true;
+    if (!cachePath) {
+        const printers = await printerNode.getPrinters({ decodeReasons });
+        return printers;
+    }
+    const cached = printerNode.readPrinterCache(cachePath, { decodeReasons });
+    if (!cached) {
+        const printers = await printerNode.getPrinters({ cachePath, decodeReasons });
+        return printers;
+    }
+    revalidatePrinters(cachePath, cached, decodeReasons);
+    return cached.map((printer) => ({ ...printer, stale: true }));
+}
+function revalidatePrinters(cachePath, cached, decodeReasons) {
+    if (revalidating.has(cachePath)) {
+        return;
+    }
+    revalidating.add(cachePath);
+    printerNode.getPrinters({ cachePath, decodeReasons })
+        .then((printers) => {
+        if (JSON.stringify(printers) !== JSON.stringify(cached)) {
+            exports.printerEvents.emit('change', printers);
+        }
+    })
+        .catch(() => {
+        // O cache continua válido; a próxima chamada tenta revalidar de novo.
+    })
+        .finally(() => revalidating.delete(cachePath));
 }
-async function getDefaultPrinter() {
-    const printer = await printerNode.getDefaultPrinter();
+async function getDefaultPrinter(options) {
+    const printer = await printerNode.getDefaultPrinter(options);
     return printer;
 }
+function decodeStateReasons(stateReasons) {
+    return printerNode.decodeStateReasons(stateReasons);
+}
+function isPrintingAvailable() {
+    return printerNode.isPrintingAvailable();
+}
+function getNativeStats() {
+    return printerNode.getNativeStats();
+}
+function setTracing(enabled) {
+    printerNode.setTracing({ enabled });
+}
+function dumpTrace(path) {
+    const trace = printerNode.dumpTrace();
+    if (path) {
+        (0, fs_1.writeFileSync)(path, trace);
+    }
+    return trace;
+}
 function normalizeString(str) {
     return String.raw `${str}`;
 }
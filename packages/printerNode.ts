@@ -1,16 +1,81 @@
 import bindings from 'bindings';
+import { EventEmitter } from 'events';
+import { writeFileSync } from 'fs';
 const printerNode = bindings('printer_electron_node');
 
+export const printerEvents = new EventEmitter();
+
+// Bits de stateReasons (ex.: PrinterStateReason.MEDIA_EMPTY), gerados pelo addon.
+export const PrinterStateReason: Readonly<Record<string, number>> = printerNode.stateReasonFlags;
+
+export type JobPriority = 'high' | 'normal' | 'bulk';
+
+export type DocumentCompression = 'gzip' | 'none';
+
 export interface PrintOptions {
   printerName: string;
   data: string | Buffer;
   dataType?: 'RAW' | 'TEXT' | 'COMMAND' | 'AUTO' | undefined;
+  priority?: JobPriority;
+  timeoutMs?: number;
+  compression?: DocumentCompression;
+}
+
+export interface PrintManyOptions extends Omit<PrintOptions, 'printerName'> {
+  printerNames: string[];
 }
 
+export interface PrintManyResult {
+  name: string;
+  status: 'success' | 'failed' | 'timeout';
+  error?: Error;
+}
+
+export type PrinterStateReasonName =
+  | 'other'
+  | 'offline'
+  | 'paused'
+  | 'moving-to-paused'
+  | 'shutdown'
+  | 'connecting-to-device'
+  | 'timed-out'
+  | 'stopping'
+  | 'stopped-partly'
+  | 'media-needed'
+  | 'media-jam'
+  | 'media-low'
+  | 'media-empty'
+  | 'input-tray-missing'
+  | 'output-tray-missing'
+  | 'output-area-almost-full'
+  | 'output-area-full'
+  | 'toner-low'
+  | 'toner-empty'
+  | 'marker-supply-low'
+  | 'marker-supply-empty'
+  | 'marker-waste-almost-full'
+  | 'marker-waste-full'
+  | 'cover-open'
+  | 'door-open'
+  | 'spool-area-full'
+  | 'resource-unavailable'
+  | 'fuser-error'
+  | 'warming-up'
+  | 'user-intervention'
+  | 'missing-filter'
+  | 'error';
+
+// 0 nenhuma condição, 1 informativa (-report), 2 aviso (-warning), 3 erro.
+export type PrinterStateSeverity = 0 | 1 | 2 | 3;
+
 export interface Printer {
   name: string;
   isDefault: boolean;
   status: string;
+  stateReasons: number;
+  stateSeverity: PrinterStateSeverity;
+  reasons?: PrinterStateReasonName[];
+  stale?: boolean;
   details: {
     location?: string;
     comment?: string;
@@ -24,10 +89,104 @@ export interface PrintDirectOptions {
   printerName: string;
   data: string | Buffer;
   dataType?: 'RAW' | 'TEXT' | 'COMMAND' | 'AUTO' | undefined;
+  priority?: JobPriority;
+  timeoutMs?: number;
+  compression?: DocumentCompression;
 }
 
 export interface GetStatusPrinterOptions {
   printerName: string;
+  decodeReasons?: boolean;
+}
+
+export interface GetDefaultPrinterOptions {
+  decodeReasons?: boolean;
+}
+
+export interface CoalescingOptions {
+  printerName: string;
+  windowMs: number;
+  maxBytes?: number;
+}
+
+export interface QueueLimitsOptions {
+  printerName: string;
+  maxQueuedJobs?: number;
+  maxQueuedBytes?: number;
+  agingMs?: number;
+}
+
+export interface QueueInfo {
+  name: string;
+  depth: number;
+  bytes: number;
+  oldestAgeMs: number;
+  printing: boolean;
+  rejected: number;
+}
+
+export interface NativeStats {
+  liveWorkers: number;
+  queues: number;
+  queuedJobs: number;
+  queuedBytes: number;
+}
+
+export interface GetPrintersOptions {
+  cachePath?: string;
+  decodeReasons?: boolean;
+}
+
+export interface RasterPage {
+  width: number;
+  height: number;
+  data: Buffer;
+  channels?: 1 | 3 | 4;
+}
+
+export interface EncodeRasterOptions {
+  pages: RasterPage[];
+  format?: 'pwg' | 'urf';
+  resolution?: number;
+  grayscale?: boolean;
+  threads?: number;
+}
+
+export interface PrintRasterOptions extends EncodeRasterOptions {
+  printerName: string;
+  compression?: DocumentCompression;
+}
+
+export interface RawStatusOptions {
+  target: string;
+  timeoutMs?: number;
+  asb?: boolean;
+}
+
+export type RawStatusCondition =
+  | 'offline'
+  | 'cover-open'
+  | 'paper-feed'
+  | 'paper-near-end'
+  | 'paper-end'
+  | 'stopped-paper-end'
+  | 'error'
+  | 'mechanical-error'
+  | 'cutter-error'
+  | 'unrecoverable-error'
+  | 'auto-recoverable-error'
+  | 'drawer-pin-high'
+  | 'waiting-online'
+  | 'no-response';
+
+export interface RawStatus {
+  target: string;
+  online: boolean;
+  flags: number;
+  conditions: RawStatusCondition[];
+  asb: boolean;
+  ageMs: number;
+  latencyMs: number;
 }
 
 export interface PrintDirectOutput {
@@ -36,15 +195,120 @@ export interface PrintDirectOutput {
 }
 
 
+const saturatedQueues = new Set<string>();
+
 export async function printDirect(printOptions: PrintOptions): Promise<PrintDirectOutput> {
   const input = {
     ...printOptions,
     printerName: normalizeString(printOptions.printerName)
   }
-  const printer = await printerNode.printDirect(input)
+  return trackQueue(input.printerName, withTimeout(printerNode.printDirect(input), input.printerName, input.timeoutMs))
+}
+
+export async function printMany(printOptions: PrintManyOptions): Promise<PrintManyResult[]> {
+  const { printerNames, ...rest } = printOptions
+  const names = printerNames.map(normalizeString)
+  // Um único payload nativo para todas as impressoras; cada uma tem a sua
+  // fila e o seu prazo, então uma estação lenta não segura as outras.
+  const jobs: Promise<PrintDirectOutput>[] = printerNode.printDirect({ ...rest, printerName: names })
+
+  return Promise.all(jobs.map(async (job, i): Promise<PrintManyResult> => {
+    try {
+      return await trackQueue(names[i], withTimeout(job, names[i], rest.timeoutMs))
+    } catch (error: any) {
+      return {
+        name: names[i],
+        status: error?.code === 'ETIMEDOUT' ? 'timeout' : 'failed',
+        error
+      }
+    }
+  }))
+}
+
+async function trackQueue<T>(printerName: string, job: Promise<T>): Promise<T> {
+  try {
+    return await job
+  } catch (error: any) {
+    if (error?.code === 'EQUEUEFULL') {
+      saturatedQueues.add(printerName)
+    }
+    throw error
+  } finally {
+    checkDrain(printerName)
+  }
+}
+
+function withTimeout<T>(job: Promise<T>, printerName: string, timeoutMs?: number): Promise<T> {
+  if (!timeoutMs || timeoutMs <= 0) {
+    return job
+  }
+
+  let timer: NodeJS.Timeout
+  const timeout = new Promise<never>((_, reject) => {
+    timer = setTimeout(() => {
+      const error: NodeJS.ErrnoException = new Error(`Print job for '${printerName}' timed out after ${timeoutMs} ms`)
+      error.code = 'ETIMEDOUT'
+      reject(error)
+    }, timeoutMs)
+  })
+  // O trabalho continua na fila nativa; se ainda não tiver sido enviado quando
+  // o prazo vencer, é descartado lá sem imprimir.
+  job.catch(() => {})
+  return Promise.race([job, timeout]).finally(() => clearTimeout(timer))
+}
+
+function checkDrain(printerName: string) {
+  if (!saturatedQueues.has(printerName)) {
+    return
+  }
+  const queue: QueueInfo = printerNode.getQueueInfo({ printerName })
+  if (queue.depth === 0) {
+    saturatedQueues.delete(printerName)
+    printerEvents.emit('drain', printerName)
+  }
+}
+
+export function setQueueLimits(options: QueueLimitsOptions): void {
+  printerNode.setQueueLimits({
+    ...options,
+    printerName: normalizeString(options.printerName)
+  })
+}
+
+export function getQueueInfo(printerName: string): QueueInfo {
+  return printerNode.getQueueInfo({ printerName: normalizeString(printerName) })
+}
+
+export function setCoalescing(options: CoalescingOptions): void {
+  printerNode.setCoalescing({
+    ...options,
+    printerName: normalizeString(options.printerName)
+  })
+}
+
+export async function printRaster(printOptions: PrintRasterOptions): Promise<PrintDirectOutput> {
+  const input = {
+    ...printOptions,
+    printerName: normalizeString(printOptions.printerName)
+  }
+  const printer = await printerNode.printRaster(input)
   return printer
 }
 
+export async function encodeRaster(options: EncodeRasterOptions): Promise<Buffer> {
+  const raster = await printerNode.encodeRaster(options)
+  return raster
+}
+
+export async function getRawStatus(options: RawStatusOptions): Promise<RawStatus> {
+  const status = await printerNode.getRawStatus(options)
+  return status
+}
+
+export function closeRawStatus(target: string): boolean {
+  return printerNode.closeRawStatus({ target })
+}
+
 export async function getStatusPrinter(printOptions: GetStatusPrinterOptions): Promise<Printer> {
   const input = {
     ...printOptions,
@@ -55,16 +319,73 @@ export async function getStatusPrinter(printOptions: GetStatusPrinterOptions): P
 }
 
 
-export async function getPrinters(): Promise<Printer[]> {
-  const printers = await printerNode.getPrinters()
-  return printers
+const revalidating = new Set<string>();
+
+export async function getPrinters(options?: GetPrintersOptions): Promise<Printer[]> {
+  const cachePath = options?.cachePath
+  const decodeReasons = options?.decodeReasons === true
+  if (!cachePath) {
+    const printers = await printerNode.getPrinters({ decodeReasons })
+    return printers
+  }
+
+  const cached: Printer[] | null = printerNode.readPrinterCache(cachePath, { decodeReasons })
+  if (!cached) {
+    const printers = await printerNode.getPrinters({ cachePath, decodeReasons })
+    return printers
+  }
+
+  revalidatePrinters(cachePath, cached, decodeReasons)
+  return cached.map((printer) => ({ ...printer, stale: true }))
+}
+
+function revalidatePrinters(cachePath: string, cached: Printer[], decodeReasons: boolean) {
+  if (revalidating.has(cachePath)) {
+    return
+  }
+  revalidating.add(cachePath)
+
+  printerNode.getPrinters({ cachePath, decodeReasons })
+    .then((printers: Printer[]) => {
+      if (JSON.stringify(printers) !== JSON.stringify(cached)) {
+        printerEvents.emit('change', printers)
+      }
+    })
+    .catch(() => {
+      // O cache continua válido; a próxima chamada tenta revalidar de novo.
+    })
+    .finally(() => revalidating.delete(cachePath))
 }
 
-export async function getDefaultPrinter(): Promise<Printer> {
-  const printer = await printerNode.getDefaultPrinter()
+export async function getDefaultPrinter(options?: GetDefaultPrinterOptions): Promise<Printer> {
+  const printer = await printerNode.getDefaultPrinter(options)
   return printer
 }
 
+export function decodeStateReasons(stateReasons: number): PrinterStateReasonName[] {
+  return printerNode.decodeStateReasons(stateReasons)
+}
+
+export function isPrintingAvailable(): boolean {
+  return printerNode.isPrintingAvailable()
+}
+
+export function getNativeStats(): NativeStats {
+  return printerNode.getNativeStats()
+}
+
+export function setTracing(enabled: boolean): void {
+  printerNode.setTracing({ enabled })
+}
+
+export function dumpTrace(path?: string): string {
+  const trace: string = printerNode.dumpTrace()
+  if (path) {
+    writeFileSync(path, trace)
+  }
+  return trace
+}
+
 
 function normalizeString(str: string) {
   return String.raw`${str}`
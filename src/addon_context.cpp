@@ -0,0 +1,216 @@
+#include "addon_context.h"
+#include "printer_factory.h"
+#include "trace.h"
+#include <system_error>
+#include <thread>
+
+std::mutex SharedResources::instanceMutex;
+std::weak_ptr<SharedResources> SharedResources::instance;
+
+SharedResources::SharedResources()
+    : printer(PrinterFactory::Create())
+{
+}
+
+std::shared_ptr<SharedResources> SharedResources::Acquire()
+{
+    std::lock_guard<std::mutex> lock(instanceMutex);
+
+    std::shared_ptr<SharedResources> resources = instance.lock();
+    if (!resources)
+    {
+        resources = std::shared_ptr<SharedResources>(new SharedResources());
+        instance = resources;
+    }
+    return resources;
+}
+
+std::shared_ptr<PrintQueue> SharedResources::GetQueue(const std::string &printerName)
+{
+    std::lock_guard<std::mutex> lock(queuesMutex);
+    auto it = queues.find(printerName);
+    if (it != queues.end())
+        return it->second;
+
+    // Uma fila que ninguém mais segura e que voltaria igual ao ser recriada
+    // pode sair. A thread dela, se ainda existir, só está esperando trabalho.
+    for (it = queues.begin(); it != queues.end();)
+    {
+        if (it->second.use_count() == 1 && it->second->IsDisposable())
+            it = queues.erase(it);
+        else
+            ++it;
+    }
+    if (queues.size() >= kMaxQueues)
+        return nullptr;
+
+    std::shared_ptr<PrintQueue> queue = std::make_shared<PrintQueue>(printerName, printer.get());
+    queues.emplace(printerName, queue);
+    return queue;
+}
+
+std::shared_ptr<PrintQueue> SharedResources::FindQueue(const std::string &printerName)
+{
+    std::lock_guard<std::mutex> lock(queuesMutex);
+    auto it = queues.find(printerName);
+    return it != queues.end() ? it->second : nullptr;
+}
+
+std::vector<std::shared_ptr<PrintQueue>> SharedResources::GetQueues()
+{
+    std::lock_guard<std::mutex> lock(queuesMutex);
+    std::vector<std::shared_ptr<PrintQueue>> list;
+    for (const auto &entry : queues)
+        list.push_back(entry.second);
+    return list;
+}
+
+PendingJobs::PendingJobs(Napi::Env env)
+    : env(env),
+      channel(Channel::New(env, "printer_electron_node:jobs", 0, 1, this)),
+      closed(false),
+      nextId(0)
+{
+    // Só segura o loop enquanto houver trabalho pendente (ver Add/Forget).
+    channel.Unref(env);
+}
+
+uint64_t PendingJobs::Add(Napi::Promise::Deferred deferred)
+{
+    if (deferreds.empty())
+        channel.Ref(env);
+    uint64_t id = ++nextId;
+    deferreds.emplace(id, deferred);
+    return id;
+}
+
+void PendingJobs::Remove(uint64_t id)
+{
+    auto it = deferreds.find(id);
+    if (it != deferreds.end())
+        Forget(it);
+}
+
+void PendingJobs::Forget(std::map<uint64_t, Napi::Promise::Deferred>::iterator it)
+{
+    deferreds.erase(it);
+    if (deferreds.empty())
+        channel.Unref(env);
+}
+
+void PendingJobs::Close()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (closed)
+            return;
+        closed = true;
+        channel.Release();
+    }
+
+    // Sem isso os Deferreds ficariam presos para sempre. Durante a saída o
+    // ambiente pode já não aceitar chamadas; nesse caso só resta soltá-los.
+    try
+    {
+        Napi::Env jsEnv(env);
+        Napi::HandleScope scope(jsEnv);
+        for (auto &entry : deferreds)
+            entry.second.Reject(Napi::Error::New(jsEnv, "Addon is shutting down").Value());
+    }
+    catch (const Napi::Error &)
+    {
+    }
+    deferreds.clear();
+}
+
+void PendingJobs::Settle(JobResult &&result)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (closed)
+        return;
+
+    JobResult *data = new JobResult(std::move(result));
+    if (channel.NonBlockingCall(data) != napi_ok)
+        delete data;
+}
+
+void PendingJobs::Deliver(Napi::Env env, Napi::Function, PendingJobs *pending, JobResult *data)
+{
+    std::unique_ptr<JobResult> result(data);
+    // Sem env, a função está sendo destruída junto com o ambiente.
+    if (env == nullptr)
+        return;
+
+    auto it = pending->deferreds.find(result->id);
+    if (it == pending->deferreds.end())
+        return;
+    Napi::Promise::Deferred deferred = it->second;
+    pending->Forget(it);
+
+    Napi::HandleScope scope(env);
+    TraceJobScope traceJob(result->traceId, result->printerName);
+    TraceSpan span("OnOK");
+
+    if (!result->error.empty())
+    {
+        Napi::Error error = Napi::Error::New(env, result->error);
+        if (!result->code.empty())
+            error.Set("code", result->code);
+        deferred.Reject(error.Value());
+        return;
+    }
+
+    Napi::Object output = Napi::Object::New(env);
+    output.Set("name", result->printerName);
+    output.Set("status", result->success ? "success" : "failed");
+    deferred.Resolve(output);
+}
+
+AddonContext::AddonContext(Napi::Env env)
+    : shared(SharedResources::Acquire()),
+      pendingJobs(std::make_shared<PendingJobs>(env)),
+      closing(false)
+{
+}
+
+AddonContext *AddonContext::Init(Napi::Env env)
+{
+    AddonContext *context = new AddonContext(env);
+    env.SetInstanceData(context);
+    env.AddCleanupHook(Cleanup, context);
+    return context;
+}
+
+AddonContext *AddonContext::Get(Napi::Env env)
+{
+    return env.GetInstanceData<AddonContext>();
+}
+
+void AddonContext::Cleanup(AddonContext *context)
+{
+    // Os trabalhos deste ambiente que ainda estão nas filas não têm mais a
+    // quem entregar o resultado; saem das filas e as promises são rejeitadas.
+    // Os lotes já em andamento terminam e o resultado é descartado.
+    context->closing = true;
+    for (const auto &queue : context->shared->GetQueues())
+        queue->Drop(context->pendingJobs.get());
+    context->pendingJobs->Close();
+
+    // Os workers em andamento seguram a sua própria referência aos recursos
+    // compartilhados, por isso o ambiente pode soltar a dele já aqui. Se for
+    // a última, o destrutor espera o lote que estiver no spooler, o que pode
+    // levar o timeout inteiro do IPP; para não travar worker.terminate() nem
+    // o fechamento de um contexto do Electron, ela é solta em outra thread.
+    std::shared_ptr<SharedResources> shared = std::move(context->shared);
+    try
+    {
+        std::thread([](std::shared_ptr<SharedResources> last)
+                    { last.reset(); },
+                    std::move(shared))
+            .detach();
+    }
+    catch (const std::system_error &)
+    {
+        // Sem como criar a thread, a referência é solta aqui mesmo.
+    }
+}
@@ -0,0 +1,104 @@
+#ifndef ADDON_CONTEXT_H
+#define ADDON_CONTEXT_H
+
+#include <napi.h>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "escpos_status.h"
+#include "printer_interface.h"
+#include "print_queue.h"
+
+// Recursos nativos compartilhados por todos os ambientes do processo (thread
+// principal, worker_threads e contextos do Electron). Cada ambiente segura uma
+// referência; o último a sair libera tudo.
+class SharedResources
+{
+public:
+    static std::shared_ptr<SharedResources> Acquire();
+
+    PrinterInterface *GetPrinter() { return printer.get(); }
+    EscPosStatusRegistry &GetEscPosStatus() { return escposStatus; }
+
+    // No máximo kMaxQueues filas ao mesmo tempo; as ociosas com configuração
+    // padrão são descartadas ao criar uma nova, para que nomes errados ou
+    // impressoras removidas não acumulem filas.
+    static constexpr size_t kMaxQueues = 256;
+
+    // Uma fila por impressora no processo inteiro: os limites, o agrupamento e
+    // a ordem de envio valem para todos os ambientes que imprimem nela.
+    // Retorna nullptr se já houver kMaxQueues filas em uso.
+    std::shared_ptr<PrintQueue> GetQueue(const std::string &printerName);
+    std::shared_ptr<PrintQueue> FindQueue(const std::string &printerName);
+    std::vector<std::shared_ptr<PrintQueue>> GetQueues();
+
+private:
+    SharedResources();
+
+    static std::mutex instanceMutex;
+    static std::weak_ptr<SharedResources> instance;
+
+    std::unique_ptr<PrinterInterface> printer;
+    EscPosStatusRegistry escposStatus;
+    // Declaradas depois do backend: as filas param as suas threads antes de ele ser liberado.
+    std::mutex queuesMutex;
+    std::map<std::string, std::shared_ptr<PrintQueue>> queues;
+};
+
+// Promises de printDirect de um ambiente. As filas guardam só o id do
+// trabalho; o Deferred fica aqui e é liquidado na thread do ambiente por uma
+// thread-safe function. Enquanto houver promise pendente a função fica com
+// ref, para o processo não sair antes de o trabalho terminar.
+class PendingJobs : public JobSink
+{
+public:
+    explicit PendingJobs(Napi::Env env);
+
+    // Thread do ambiente.
+    uint64_t Add(Napi::Promise::Deferred deferred);
+    void Remove(uint64_t id);
+    // Thread do ambiente, na saída: rejeita as promises ainda pendentes, e os
+    // resultados que chegarem depois são descartados.
+    void Close();
+
+    // Qualquer thread. Ids já liquidados são ignorados.
+    void Settle(JobResult &&result) override;
+
+private:
+    static void Deliver(Napi::Env env, Napi::Function, PendingJobs *pending, JobResult *result);
+    using Channel = Napi::TypedThreadSafeFunction<PendingJobs, JobResult, Deliver>;
+
+    void Forget(std::map<uint64_t, Napi::Promise::Deferred>::iterator it);
+
+    napi_env env;
+    Channel channel;
+    std::mutex mutex;
+    bool closed;
+    uint64_t nextId;
+    std::map<uint64_t, Napi::Promise::Deferred> deferreds;
+};
+
+// Estado por ambiente, guardado com napi_set_instance_data.
+class AddonContext
+{
+public:
+    static AddonContext *Init(Napi::Env env);
+    static AddonContext *Get(Napi::Env env);
+
+    std::shared_ptr<SharedResources> GetShared() const { return shared; }
+    std::shared_ptr<PendingJobs> GetPendingJobs() const { return pendingJobs; }
+    // Depois do cleanup hook as chamadas assíncronas rejeitam sem enfileirar nada.
+    bool IsClosing() const { return closing; }
+
+private:
+    explicit AddonContext(Napi::Env env);
+    static void Cleanup(AddonContext *context);
+
+    std::shared_ptr<SharedResources> shared;
+    std::shared_ptr<PendingJobs> pendingJobs;
+    bool closing;
+};
+
+#endif
@@ -0,0 +1,66 @@
+#include "cups_loader.h"
+#include <dlfcn.h>
+#include <mutex>
+
+namespace
+{
+    const char *const kLibraryNames[] = {
+#ifdef __APPLE__
+        "libcups.2.dylib",
+        "/usr/lib/libcups.2.dylib",
+#else
+        "libcups.so.2",
+        "libcups.so",
+#endif
+    };
+
+    CupsApi api;
+    bool loaded = false;
+    std::string loadError;
+    std::once_flag loadOnce;
+
+    void Load()
+    {
+        void *library = nullptr;
+        for (const char *name : kLibraryNames)
+        {
+            library = dlopen(name, RTLD_NOW | RTLD_LOCAL);
+            if (library)
+                break;
+            // Guarda o erro do primeiro nome, o da versão de ABI esperada.
+            const char *error = dlerror();
+            if (loadError.empty())
+                loadError = error ? error : std::string("could not load ") + name;
+        }
+        if (!library)
+            return;
+
+#define CUPS_API_RESOLVE(name)                                                \
+    api.name = reinterpret_cast<decltype(api.name)>(dlsym(library, #name));   \
+    if (!api.name)                                                            \
+    {                                                                         \
+        loadError = "libcups does not export " #name;                         \
+        dlclose(library);                                                     \
+        return;                                                               \
+    }
+        CUPS_API_FUNCTIONS(CUPS_API_RESOLVE)
+#undef CUPS_API_RESOLVE
+
+        // A biblioteca fica carregada até o fim do processo.
+        loaded = true;
+    }
+}
+
+const CupsApi &CupsApi::Get()
+{
+    std::call_once(loadOnce, Load);
+    if (!loaded)
+        throw PrintingUnavailableError(loadError);
+    return api;
+}
+
+bool CupsApi::IsAvailable()
+{
+    std::call_once(loadOnce, Load);
+    return loaded;
+}
@@ -0,0 +1,60 @@
+#ifndef CUPS_LOADER_H
+#define CUPS_LOADER_H
+
+#include <cups/cups.h>
+#include <stdexcept>
+#include <string>
+
+// Funções da libcups usadas pelos backends. Os headers continuam sendo usados
+// para os tipos e protótipos, mas o addon não linka contra a biblioteca.
+#define CUPS_API_FUNCTIONS(X) \
+    X(cupsCancelJob)          \
+    X(cupsCreateJob)          \
+    X(cupsDoRequest)          \
+    X(cupsFinishDocument)     \
+    X(cupsFreeDests)          \
+    X(cupsGetDest)            \
+    X(cupsGetDests)           \
+    X(cupsGetResponse)        \
+    X(cupsLastError)          \
+    X(cupsSendRequest)        \
+    X(cupsServer)             \
+    X(cupsStartDocument)      \
+    X(cupsUser)               \
+    X(cupsWriteRequestData)   \
+    X(httpAssembleURIf)       \
+    X(httpClose)              \
+    X(httpConnect2)           \
+    X(ippAddBoolean)          \
+    X(ippAddInteger)          \
+    X(ippAddString)           \
+    X(ippDelete)              \
+    X(ippFindAttribute)       \
+    X(ippGetCount)            \
+    X(ippGetInteger)          \
+    X(ippGetString)           \
+    X(ippNewRequest)          \
+    X(ippPort)
+
+class PrintingUnavailableError : public std::runtime_error
+{
+public:
+    explicit PrintingUnavailableError(const std::string &reason)
+        : std::runtime_error("Printing unavailable: " + reason) {}
+};
+
+// Tabela de funções da libcups, resolvida com dlopen/dlsym no primeiro uso.
+// Carregar o addon não puxa a libcups nem as suas dependências (TLS, GSSAPI),
+// e uma máquina sem CUPS só recebe erro ao tentar imprimir.
+struct CupsApi
+{
+#define CUPS_API_DECLARE(name) decltype(&::name) name;
+    CUPS_API_FUNCTIONS(CUPS_API_DECLARE)
+#undef CUPS_API_DECLARE
+
+    // Lança PrintingUnavailableError se a biblioteca não puder ser carregada.
+    static const CupsApi &Get();
+    static bool IsAvailable();
+};
+
+#endif
@@ -0,0 +1,769 @@
+#include "escpos_status.h"
+#include <algorithm>
+#include <stdexcept>
+#include <cstring>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#pragma comment(lib, "ws2_32.lib")
+#else
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <termios.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    const intptr_t kInvalidHandle = -1;
+    const char kDefaultPort[] = "9100";
+
+    // DLE EOT 1..4 enviados de uma vez: são comandos de tempo real, respondidos
+    // na ordem, então uma única ida e volta traz os quatro bytes de status.
+    const uint8_t kRealtimeQuery[] = {0x10, 0x04, 0x01, 0x10, 0x04, 0x02, 0x10, 0x04, 0x03, 0x10, 0x04, 0x04};
+    const uint8_t kPaperSensorQuery[] = {0x1d, 0x72, 0x01};
+    const uint8_t kEnableAsb[] = {0x1d, 0x61, 0x0f};
+    const uint8_t kDisableAsb[] = {0x1d, 0x61, 0x00};
+
+    double ElapsedMs(std::chrono::steady_clock::time_point since)
+    {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - since).count();
+    }
+
+    int RemainingMs(std::chrono::steady_clock::time_point deadline)
+    {
+        auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now()).count();
+        return left > 0 ? static_cast<int>(left) : 0;
+    }
+
+    bool IsDeviceTarget(const std::string &target)
+    {
+        return !target.empty() && (target[0] == '/' || target.compare(0, 3, "COM") == 0);
+    }
+
+#ifdef _WIN32
+    void EnsureWinsock()
+    {
+        static bool started = false;
+        static std::mutex startMutex;
+        std::lock_guard<std::mutex> lock(startMutex);
+        if (!started)
+        {
+            WSADATA data;
+            if (WSAStartup(MAKEWORD(2, 2), &data) != 0)
+                throw std::runtime_error("WSAStartup failed");
+            started = true;
+        }
+    }
+
+    int LastSocketError() { return WSAGetLastError(); }
+#else
+    int LastSocketError() { return errno; }
+#endif
+}
+
+bool EscPosStatusParser::ParseRealtime(uint8_t n, uint8_t reply, uint32_t &flags)
+{
+    // Respostas de DLE EOT têm o bit 1 e o bit 4 fixos em 1 e os bits 0 e 7 em 0.
+    if ((reply & 0x93) != 0x12)
+        return false;
+
+    switch (n)
+    {
+    case 1:
+        if (reply & 0x04)
+            flags |= ESCPOS_DRAWER_PIN_HIGH;
+        if (reply & 0x08)
+            flags |= ESCPOS_OFFLINE;
+        if (reply & 0x20)
+            flags |= ESCPOS_WAITING_ONLINE;
+        return true;
+    case 2:
+        if (reply & 0x04)
+            flags |= ESCPOS_COVER_OPEN;
+        if (reply & 0x08)
+            flags |= ESCPOS_PAPER_FEED;
+        if (reply & 0x20)
+            flags |= ESCPOS_STOPPED_PAPER_END;
+        if (reply & 0x40)
+            flags |= ESCPOS_ERROR;
+        return true;
+    case 3:
+        if (reply & 0x04)
+            flags |= ESCPOS_MECHANICAL_ERROR;
+        if (reply & 0x08)
+            flags |= ESCPOS_CUTTER_ERROR;
+        if (reply & 0x20)
+            flags |= ESCPOS_UNRECOVERABLE_ERROR;
+        if (reply & 0x40)
+            flags |= ESCPOS_AUTO_RECOVERABLE_ERROR;
+        return true;
+    case 4:
+        if (reply & 0x0c)
+            flags |= ESCPOS_PAPER_NEAR_END;
+        if (reply & 0x60)
+            flags |= ESCPOS_PAPER_END;
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool EscPosStatusParser::ParsePaperSensor(uint8_t reply, uint32_t &flags)
+{
+    if ((reply & 0x90) != 0)
+        return false;
+    if (reply & 0x03)
+        flags |= ESCPOS_PAPER_NEAR_END;
+    if (reply & 0x0c)
+        flags |= ESCPOS_PAPER_END;
+    return true;
+}
+
+bool EscPosStatusParser::IsAsbHeader(uint8_t byte)
+{
+    return (byte & 0x93) == 0x10;
+}
+
+uint32_t EscPosStatusParser::ParseAsb(const uint8_t frame[4])
+{
+    uint32_t flags = 0;
+
+    if (frame[0] & 0x04)
+        flags |= ESCPOS_DRAWER_PIN_HIGH;
+    if (frame[0] & 0x08)
+        flags |= ESCPOS_OFFLINE;
+    if (frame[0] & 0x20)
+        flags |= ESCPOS_COVER_OPEN;
+    if (frame[0] & 0x40)
+        flags |= ESCPOS_PAPER_FEED;
+
+    if (frame[1] & 0x04)
+        flags |= ESCPOS_MECHANICAL_ERROR;
+    if (frame[1] & 0x08)
+        flags |= ESCPOS_CUTTER_ERROR;
+    if (frame[1] & 0x20)
+        flags |= ESCPOS_UNRECOVERABLE_ERROR;
+    if (frame[1] & 0x40)
+        flags |= ESCPOS_AUTO_RECOVERABLE_ERROR;
+    if (frame[1] & 0x6c)
+        flags |= ESCPOS_ERROR;
+
+    if (frame[2] & 0x03)
+        flags |= ESCPOS_PAPER_NEAR_END;
+    if (frame[2] & 0x0c)
+        flags |= ESCPOS_PAPER_END;
+
+    return flags;
+}
+
+std::vector<std::string> EscPosStatusParser::Describe(uint32_t flags)
+{
+    static const struct
+    {
+        uint32_t flag;
+        const char *name;
+    } names[] = {
+        {ESCPOS_OFFLINE, "offline"},
+        {ESCPOS_COVER_OPEN, "cover-open"},
+        {ESCPOS_PAPER_FEED, "paper-feed"},
+        {ESCPOS_PAPER_NEAR_END, "paper-near-end"},
+        {ESCPOS_PAPER_END, "paper-end"},
+        {ESCPOS_STOPPED_PAPER_END, "stopped-paper-end"},
+        {ESCPOS_ERROR, "error"},
+        {ESCPOS_MECHANICAL_ERROR, "mechanical-error"},
+        {ESCPOS_CUTTER_ERROR, "cutter-error"},
+        {ESCPOS_UNRECOVERABLE_ERROR, "unrecoverable-error"},
+        {ESCPOS_AUTO_RECOVERABLE_ERROR, "auto-recoverable-error"},
+        {ESCPOS_DRAWER_PIN_HIGH, "drawer-pin-high"},
+        {ESCPOS_WAITING_ONLINE, "waiting-online"},
+        {ESCPOS_NO_RESPONSE, "no-response"},
+    };
+
+    std::vector<std::string> result;
+    for (const auto &entry : names)
+    {
+        if (flags & entry.flag)
+            result.push_back(entry.name);
+    }
+    return result;
+}
+
+RawChannel::RawChannel()
+    : handle(kInvalidHandle),
+      isSocket(false)
+{
+}
+
+RawChannel::~RawChannel()
+{
+    Close();
+}
+
+bool RawChannel::IsOpen() const
+{
+    return handle != kInvalidHandle;
+}
+
+void RawChannel::Open(const std::string &target, int timeoutMs)
+{
+    Close();
+
+    std::string address = target;
+    if (address.compare(0, 6, "tcp://") == 0)
+    {
+        address = address.substr(6);
+    }
+    else if (IsDeviceTarget(address))
+    {
+#ifdef _WIN32
+        throw std::runtime_error("Device targets are not supported on Windows: " + target);
+#else
+        int fd = open(address.c_str(), O_RDWR | O_NOCTTY | O_NONBLOCK);
+        if (fd < 0)
+            throw std::runtime_error("Cannot open " + target + ": " + strerror(errno));
+
+        if (isatty(fd))
+        {
+            struct termios tio;
+            if (tcgetattr(fd, &tio) == 0)
+            {
+                cfmakeraw(&tio);
+                tcsetattr(fd, TCSANOW, &tio);
+            }
+        }
+
+        handle = fd;
+        isSocket = false;
+        return;
+#endif
+    }
+
+    std::string host = address;
+    std::string port = kDefaultPort;
+    if (!address.empty() && address[0] == '[')
+    {
+        size_t end = address.find(']');
+        host = address.substr(1, end == std::string::npos ? std::string::npos : end - 1);
+        if (end != std::string::npos && address.compare(end + 1, 1, ":") == 0)
+            port = address.substr(end + 2);
+    }
+    else if (address.find(':') != std::string::npos && address.find(':') == address.rfind(':'))
+    {
+        host = address.substr(0, address.find(':'));
+        port = address.substr(address.find(':') + 1);
+    }
+
+#ifdef _WIN32
+    EnsureWinsock();
+#endif
+
+    struct addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+
+    struct addrinfo *addresses = NULL;
+    if (getaddrinfo(host.c_str(), port.c_str(), &hints, &addresses) != 0 || addresses == NULL)
+        throw std::runtime_error("Cannot resolve " + target);
+
+    std::string lastError = "Cannot connect to " + target;
+    for (struct addrinfo *ai = addresses; ai != NULL && handle == kInvalidHandle; ai = ai->ai_next)
+    {
+#ifdef _WIN32
+        SOCKET fd = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+        if (fd == INVALID_SOCKET)
+            continue;
+        u_long nonBlocking = 1;
+        ioctlsocket(fd, FIONBIO, &nonBlocking);
+#else
+        int fd = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+        if (fd < 0)
+            continue;
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+#ifdef SO_NOSIGPIPE
+        int noSigpipe = 1;
+        setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &noSigpipe, sizeof(noSigpipe));
+#endif
+#endif
+        int noDelay = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char *>(&noDelay), sizeof(noDelay));
+
+        handle = static_cast<intptr_t>(fd);
+        isSocket = true;
+
+        if (connect(fd, ai->ai_addr, static_cast<int>(ai->ai_addrlen)) == 0)
+            break;
+
+        int error = LastSocketError();
+#ifdef _WIN32
+        bool pending = error == WSAEWOULDBLOCK;
+#else
+        bool pending = error == EINPROGRESS;
+#endif
+        if (pending && WaitReady(true, timeoutMs))
+        {
+            int soError = 0;
+            socklen_t length = sizeof(soError);
+            getsockopt(fd, SOL_SOCKET, SO_ERROR, reinterpret_cast<char *>(&soError), &length);
+            if (soError == 0)
+                break;
+            lastError = "Cannot connect to " + target + ": " + strerror(soError);
+        }
+        else if (pending)
+        {
+            lastError = "Timed out connecting to " + target;
+        }
+        Close();
+    }
+    freeaddrinfo(addresses);
+
+    if (handle == kInvalidHandle)
+        throw std::runtime_error(lastError);
+}
+
+void RawChannel::Close()
+{
+    if (handle == kInvalidHandle)
+        return;
+#ifdef _WIN32
+    closesocket(static_cast<SOCKET>(handle));
+#else
+    close(static_cast<int>(handle));
+#endif
+    handle = kInvalidHandle;
+}
+
+bool RawChannel::WaitReady(bool forWrite, int timeoutMs)
+{
+#ifdef _WIN32
+    fd_set set;
+    FD_ZERO(&set);
+    FD_SET(static_cast<SOCKET>(handle), &set);
+    timeval tv = {timeoutMs / 1000, (timeoutMs % 1000) * 1000};
+    int ready = select(0, forWrite ? NULL : &set, forWrite ? &set : NULL, NULL, &tv);
+#else
+    struct pollfd pfd = {static_cast<int>(handle), static_cast<short>(forWrite ? POLLOUT : POLLIN), 0};
+    int ready;
+    do
+    {
+        ready = poll(&pfd, 1, timeoutMs);
+    } while (ready < 0 && errno == EINTR);
+#endif
+    if (ready < 0)
+        throw std::runtime_error("Raw channel wait failed");
+    return ready > 0;
+}
+
+void RawChannel::Write(const uint8_t *data, size_t size, int timeoutMs)
+{
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+
+    while (size > 0)
+    {
+        if (!WaitReady(true, RemainingMs(deadline)))
+            throw std::runtime_error("Timed out writing to printer");
+
+#ifdef _WIN32
+        int written = send(static_cast<SOCKET>(handle), reinterpret_cast<const char *>(data), static_cast<int>(size), 0);
+        if (written < 0 && WSAGetLastError() == WSAEWOULDBLOCK)
+            continue;
+#else
+        ssize_t written;
+        if (isSocket)
+        {
+#ifdef MSG_NOSIGNAL
+            written = send(static_cast<int>(handle), data, size, MSG_NOSIGNAL);
+#else
+            written = send(static_cast<int>(handle), data, size, 0);
+#endif
+        }
+        else
+        {
+            written = write(static_cast<int>(handle), data, size);
+        }
+        if (written < 0 && (errno == EAGAIN || errno == EINTR))
+            continue;
+#endif
+        if (written < 0)
+            throw std::runtime_error("Write to printer failed");
+
+        data += written;
+        size -= static_cast<size_t>(written);
+    }
+}
+
+size_t RawChannel::Read(uint8_t *data, size_t size, int timeoutMs)
+{
+    if (!WaitReady(false, timeoutMs))
+        return 0;
+
+#ifdef _WIN32
+    int received = recv(static_cast<SOCKET>(handle), reinterpret_cast<char *>(data), static_cast<int>(size), 0);
+    if (received < 0 && WSAGetLastError() == WSAEWOULDBLOCK)
+        return 0;
+#else
+    ssize_t received = isSocket ? recv(static_cast<int>(handle), data, size, 0)
+                                : read(static_cast<int>(handle), data, size);
+    if (received < 0 && (errno == EAGAIN || errno == EINTR))
+        return 0;
+#endif
+    if (received < 0)
+        throw std::runtime_error("Read from printer failed");
+    if (received == 0)
+        throw std::runtime_error("Printer closed the connection");
+    return static_cast<size_t>(received);
+}
+
+void RawChannel::Drain()
+{
+    uint8_t discard[64];
+    while (Read(discard, sizeof(discard), 0) > 0)
+    {
+    }
+}
+
+EscPosStatusChannel::EscPosStatusChannel(const std::string &target)
+    : target(target),
+      stopReader(false),
+      asbActive(false),
+      asbUnsupported(false),
+      hasStatus(false),
+      lastFlags(0)
+{
+}
+
+EscPosStatusChannel::~EscPosStatusChannel()
+{
+    Close();
+}
+
+EscPosStatus EscPosStatusChannel::Query(bool useAsb, int timeoutMs)
+{
+    auto start = std::chrono::steady_clock::now();
+    auto deadline = start + std::chrono::milliseconds(timeoutMs);
+    std::lock_guard<std::mutex> queryLock(queryMutex);
+
+    bool readerFailed;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        readerFailed = !asbActive && reader.joinable();
+    }
+    if (readerFailed)
+    {
+        // A thread de ASB saiu por erro de leitura; recolhe e reconecta.
+        StopReader();
+        channel.Close();
+    }
+
+    if (!channel.IsOpen())
+    {
+        channel.Open(target, RemainingMs(deadline));
+        asbUnsupported = false;
+    }
+
+    // Ao ligar o ASB, o primeiro pacote pode não vir; espera só metade do
+    // prazo, para sobrar tempo para a consulta de tempo real.
+    auto asbDeadline = deadline;
+    if (useAsb && !asbUnsupported && !reader.joinable())
+    {
+        EnableAsb(RemainingMs(deadline));
+        asbDeadline = start + std::chrono::milliseconds(timeoutMs / 2);
+    }
+
+    if (reader.joinable())
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        updated.wait_until(lock, asbDeadline, [this]
+                           { return hasStatus || !asbActive; });
+        if (asbActive && hasStatus)
+        {
+            EscPosStatus status;
+            status.flags = lastFlags;
+            status.asb = true;
+            status.ageMs = ElapsedMs(lastUpdate);
+            status.latencyMs = ElapsedMs(start);
+            return status;
+        }
+
+        bool failed = !asbActive;
+        lock.unlock();
+
+        // Sem pacote de ASB dentro do prazo: a impressora não suporta GS a,
+        // então seguimos só com as consultas de tempo real nesta conexão.
+        DisableAsb();
+        if (failed)
+        {
+            channel.Close();
+            channel.Open(target, RemainingMs(deadline));
+        }
+        else
+        {
+            asbUnsupported = true;
+        }
+    }
+
+    EscPosStatus status = QueryRealtime(deadline);
+    status.latencyMs = ElapsedMs(start);
+    return status;
+}
+
+EscPosStatus EscPosStatusChannel::QueryRealtime(std::chrono::steady_clock::time_point deadline)
+{
+    EscPosStatus status;
+
+    try
+    {
+        channel.Drain();
+        channel.Write(kRealtimeQuery, sizeof(kRealtimeQuery), RemainingMs(deadline));
+
+        uint8_t replies[4];
+        size_t received = 0;
+        while (received < sizeof(replies))
+        {
+            size_t read = channel.Read(replies + received, sizeof(replies) - received, RemainingMs(deadline));
+            if (read == 0)
+                break;
+            received += read;
+        }
+
+        if (received == 0)
+        {
+            status.flags = ESCPOS_NO_RESPONSE;
+            return status;
+        }
+
+        for (size_t i = 0; i < received; i++)
+        {
+            if (!EscPosStatusParser::ParseRealtime(static_cast<uint8_t>(i + 1), replies[i], status.flags))
+            {
+                status.flags |= ESCPOS_NO_RESPONSE;
+                return status;
+            }
+        }
+
+        // Alguns modelos não implementam DLE EOT 4; o sensor de papel vem então por GS r 1.
+        if (received == 3)
+        {
+            uint8_t paper;
+            channel.Write(kPaperSensorQuery, sizeof(kPaperSensorQuery), RemainingMs(deadline));
+            if (channel.Read(&paper, 1, RemainingMs(deadline)) == 1)
+            {
+                EscPosStatusParser::ParsePaperSensor(paper, status.flags);
+            }
+        }
+    }
+    catch (...)
+    {
+        channel.Close();
+        throw;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    lastFlags = status.flags;
+    lastUpdate = std::chrono::steady_clock::now();
+    return status;
+}
+
+void EscPosStatusChannel::EnableAsb(int timeoutMs)
+{
+    channel.Drain();
+    channel.Write(kEnableAsb, sizeof(kEnableAsb), timeoutMs);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        asbActive = true;
+        hasStatus = false;
+    }
+    stopReader = false;
+    reader = std::thread(&EscPosStatusChannel::ReaderLoop, this);
+}
+
+void EscPosStatusChannel::DisableAsb()
+{
+    bool wasActive;
+    StopReader();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        wasActive = asbActive;
+        asbActive = false;
+        hasStatus = false;
+    }
+
+    if (wasActive && channel.IsOpen())
+    {
+        try
+        {
+            channel.Write(kDisableAsb, sizeof(kDisableAsb), 200);
+        }
+        catch (const std::exception &)
+        {
+            channel.Close();
+        }
+    }
+}
+
+void EscPosStatusChannel::ReaderLoop()
+{
+    std::vector<uint8_t> pending;
+    uint8_t buffer[64];
+
+    try
+    {
+        while (!stopReader)
+        {
+            size_t read = channel.Read(buffer, sizeof(buffer), 100);
+            pending.insert(pending.end(), buffer, buffer + read);
+
+            size_t i = 0;
+            while (i + 4 <= pending.size())
+            {
+                const uint8_t *frame = pending.data() + i;
+                if (!EscPosStatusParser::IsAsbHeader(frame[0]) ||
+                    (frame[1] & 0x90) || (frame[2] & 0x90) || (frame[3] & 0x90))
+                {
+                    i++;
+                    continue;
+                }
+
+                uint32_t flags = EscPosStatusParser::ParseAsb(frame);
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    lastFlags = flags;
+                    lastUpdate = std::chrono::steady_clock::now();
+                    hasStatus = true;
+                }
+                updated.notify_all();
+                i += 4;
+            }
+            pending.erase(pending.begin(), pending.begin() + i);
+        }
+    }
+    catch (const std::exception &)
+    {
+        // O canal é fechado por quem recolher a thread, nunca por ela mesma.
+        std::lock_guard<std::mutex> lock(mutex);
+        asbActive = false;
+        hasStatus = false;
+    }
+    updated.notify_all();
+}
+
+void EscPosStatusChannel::StopReader()
+{
+    stopReader = true;
+    if (reader.joinable())
+        reader.join();
+}
+
+void EscPosStatusChannel::Close()
+{
+    std::lock_guard<std::mutex> queryLock(queryMutex);
+    DisableAsb();
+    channel.Close();
+}
+
+EscPosStatusRegistry::EscPosStatusRegistry()
+    : stopping(false)
+{
+}
+
+EscPosStatusRegistry::~EscPosStatusRegistry()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    changed.notify_all();
+    if (sweeper.joinable())
+        sweeper.join();
+}
+
+std::shared_ptr<EscPosStatusChannel> EscPosStatusRegistry::Get(const std::string &target)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    Entry &entry = channels[target];
+    if (!entry.channel)
+    {
+        entry.channel = std::make_shared<EscPosStatusChannel>(target);
+    }
+    entry.lastUsed = std::chrono::steady_clock::now();
+
+    if (!sweeper.joinable())
+        sweeper = std::thread(&EscPosStatusRegistry::SweepLoop, this);
+    changed.notify_all();
+    return entry.channel;
+}
+
+bool EscPosStatusRegistry::Close(const std::string &target)
+{
+    std::shared_ptr<EscPosStatusChannel> channel;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = channels.find(target);
+        if (it == channels.end())
+            return false;
+        channel = it->second.channel;
+        channels.erase(it);
+    }
+    channel->Close();
+    return true;
+}
+
+void EscPosStatusRegistry::SweepLoop()
+{
+    const auto idle = std::chrono::milliseconds(kIdleMs);
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;)
+    {
+        changed.wait(lock, [this]
+                     { return stopping || !channels.empty(); });
+        if (stopping)
+            return;
+
+        // Acorda quando o canal usado há mais tempo completar kIdleMs parado;
+        // no mínimo um segundo depois, caso ele ainda esteja em uso.
+        auto oldest = std::chrono::steady_clock::time_point::max();
+        for (const auto &entry : channels)
+        {
+            if (entry.second.lastUsed < oldest)
+                oldest = entry.second.lastUsed;
+        }
+        auto wake = std::max(oldest + idle, std::chrono::steady_clock::now() + std::chrono::seconds(1));
+        changed.wait_until(lock, wake, [this]
+                           { return stopping; });
+        if (stopping)
+            return;
+
+        auto now = std::chrono::steady_clock::now();
+        std::vector<std::shared_ptr<EscPosStatusChannel>> expired;
+        for (auto it = channels.begin(); it != channels.end();)
+        {
+            // Um canal ainda segurado por uma consulta em andamento fica.
+            if (now - it->second.lastUsed >= idle && it->second.channel.use_count() == 1)
+            {
+                expired.push_back(std::move(it->second.channel));
+                it = channels.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+
+        // Close desliga o ASB e pode esperar a escrita; fora do lock, para não
+        // travar as consultas a outros destinos.
+        lock.unlock();
+        for (auto &channel : expired)
+            channel->Close();
+        expired.clear();
+        lock.lock();
+    }
+}
@@ -0,0 +1,145 @@
+#ifndef ESCPOS_STATUS_H
+#define ESCPOS_STATUS_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstdint>
+
+enum EscPosStatusFlag : uint32_t
+{
+    ESCPOS_OFFLINE = 1u << 0,
+    ESCPOS_COVER_OPEN = 1u << 1,
+    ESCPOS_PAPER_FEED = 1u << 2,
+    ESCPOS_PAPER_NEAR_END = 1u << 3,
+    ESCPOS_PAPER_END = 1u << 4,
+    ESCPOS_STOPPED_PAPER_END = 1u << 5,
+    ESCPOS_ERROR = 1u << 6,
+    ESCPOS_MECHANICAL_ERROR = 1u << 7,
+    ESCPOS_CUTTER_ERROR = 1u << 8,
+    ESCPOS_UNRECOVERABLE_ERROR = 1u << 9,
+    ESCPOS_AUTO_RECOVERABLE_ERROR = 1u << 10,
+    ESCPOS_DRAWER_PIN_HIGH = 1u << 11,
+    ESCPOS_WAITING_ONLINE = 1u << 12,
+    ESCPOS_NO_RESPONSE = 1u << 31
+};
+
+struct EscPosStatus
+{
+    uint32_t flags = 0;
+    bool asb = false;      // veio de Automatic Status Back, sem ida e volta
+    double ageMs = 0;      // idade da última leitura
+    double latencyMs = 0;  // tempo gasto para responder esta consulta
+};
+
+// Decodifica as respostas de DLE EOT n, GS r n e dos pacotes de ASB (GS a).
+class EscPosStatusParser
+{
+public:
+    static bool ParseRealtime(uint8_t n, uint8_t reply, uint32_t &flags);
+    static bool ParsePaperSensor(uint8_t reply, uint32_t &flags);
+    static bool IsAsbHeader(uint8_t byte);
+    static uint32_t ParseAsb(const uint8_t frame[4]);
+    static std::vector<std::string> Describe(uint32_t flags);
+};
+
+// Canal bidirecional com a impressora, sem passar pelo spooler: TCP (porta
+// 9100) ou um nó de dispositivo (/dev/usb/lp0, /dev/ttyUSB0, pty...).
+class RawChannel
+{
+public:
+    RawChannel();
+    ~RawChannel();
+
+    // target: "tcp://host:porta", "host:porta" ou caminho de dispositivo.
+    void Open(const std::string &target, int timeoutMs);
+    void Close();
+    bool IsOpen() const;
+
+    void Write(const uint8_t *data, size_t size, int timeoutMs);
+    // Retorna quantos bytes foram lidos; 0 em timeout. Lança em erro ou EOF.
+    size_t Read(uint8_t *data, size_t size, int timeoutMs);
+    void Drain();
+
+private:
+    bool WaitReady(bool forWrite, int timeoutMs);
+
+    intptr_t handle;
+    bool isSocket;
+};
+
+// Motor de status de uma impressora. Mantém a conexão aberta entre consultas
+// e, com ASB ativo, uma thread que recebe os pacotes de status enviados pela
+// própria impressora, de modo que a consulta responde sem ida e volta.
+class EscPosStatusChannel
+{
+public:
+    explicit EscPosStatusChannel(const std::string &target);
+    ~EscPosStatusChannel();
+
+    // timeoutMs vale para a consulta inteira: conexão, espera do ASB e as
+    // leituras de tempo real dividem o mesmo prazo.
+    EscPosStatus Query(bool useAsb, int timeoutMs);
+    void Close();
+
+private:
+    EscPosStatus QueryRealtime(std::chrono::steady_clock::time_point deadline);
+    void EnableAsb(int timeoutMs);
+    void DisableAsb();
+    void ReaderLoop();
+    void StopReader();
+
+    std::string target;
+    // queryMutex serializa consultas e o uso do canal; mutex protege apenas o
+    // estado compartilhado com a thread de ASB.
+    std::mutex queryMutex;
+    std::mutex mutex;
+    std::condition_variable updated;
+    RawChannel channel;
+    std::thread reader;
+    std::atomic<bool> stopReader;
+    bool asbActive;
+    bool asbUnsupported;
+    bool hasStatus;
+    uint32_t lastFlags;
+    std::chrono::steady_clock::time_point lastUpdate;
+};
+
+// Canais compartilhados pelo processo, um por destino. Um canal sem consultas
+// por kIdleMs é fechado por uma thread de limpeza, para que cada destino já
+// consultado não segure para sempre um socket e a thread de ASB; a próxima
+// consulta reabre a conexão.
+class EscPosStatusRegistry
+{
+public:
+    static constexpr uint32_t kIdleMs = 60000;
+
+    EscPosStatusRegistry();
+    ~EscPosStatusRegistry();
+
+    std::shared_ptr<EscPosStatusChannel> Get(const std::string &target);
+    bool Close(const std::string &target);
+
+private:
+    struct Entry
+    {
+        std::shared_ptr<EscPosStatusChannel> channel;
+        std::chrono::steady_clock::time_point lastUsed;
+    };
+
+    void SweepLoop();
+
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::map<std::string, Entry> channels;
+    bool stopping;
+    std::thread sweeper;
+};
+
+#endif
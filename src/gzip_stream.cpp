@@ -0,0 +1,261 @@
+#include "gzip_stream.h"
+#include "trace.h"
+#include <condition_variable>
+#include <deque>
+#include <dlfcn.h>
+#include <mutex>
+#include <thread>
+#include <zlib.h>
+
+namespace
+{
+    const char *const kLibraryNames[] = {
+#ifdef __APPLE__
+        "libz.1.dylib",
+        "/usr/lib/libz.1.dylib",
+#else
+        "libz.so.1",
+        "libz.so",
+#endif
+    };
+
+#define ZLIB_API_FUNCTIONS(X) \
+    X(deflate)                \
+    X(deflateEnd)             \
+    X(deflateInit2_)
+
+    struct ZlibApi
+    {
+#define ZLIB_API_DECLARE(name) decltype(&::name) name;
+        ZLIB_API_FUNCTIONS(ZLIB_API_DECLARE)
+#undef ZLIB_API_DECLARE
+    };
+
+    ZlibApi api;
+    bool loaded = false;
+    std::once_flag loadOnce;
+
+    void Load()
+    {
+        void *library = nullptr;
+        for (const char *name : kLibraryNames)
+        {
+            library = dlopen(name, RTLD_NOW | RTLD_LOCAL);
+            if (library)
+                break;
+        }
+        if (!library)
+            return;
+
+#define ZLIB_API_RESOLVE(name)                                              \
+    api.name = reinterpret_cast<decltype(api.name)>(dlsym(library, #name)); \
+    if (!api.name)                                                          \
+    {                                                                       \
+        dlclose(library);                                                   \
+        return;                                                             \
+    }
+        ZLIB_API_FUNCTIONS(ZLIB_API_RESOLVE)
+#undef ZLIB_API_RESOLVE
+
+        loaded = true;
+    }
+
+    // Fila limitada de blocos comprimidos entre a thread do deflate e a do envio.
+    class BlockChannel
+    {
+    public:
+        // Thread do deflate. Retorna false se o envio já desistiu.
+        bool Push(std::vector<uint8_t> &&block)
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            spaceAvailable.wait(lock, [this]
+                                { return cancelled || blocks.size() < GzipStream::kMaxPendingBlocks; });
+            if (cancelled)
+                return false;
+            blocks.push_back(std::move(block));
+            blockAvailable.notify_one();
+            return true;
+        }
+
+        void Finish(bool ok)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            finished = true;
+            succeeded = ok;
+            blockAvailable.notify_one();
+        }
+
+        // Thread do envio. Retorna false quando não há mais blocos.
+        bool Pop(std::vector<uint8_t> &block)
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            blockAvailable.wait(lock, [this]
+                                { return finished || !blocks.empty(); });
+            if (blocks.empty())
+                return false;
+            block = std::move(blocks.front());
+            blocks.pop_front();
+            spaceAvailable.notify_one();
+            return true;
+        }
+
+        void Cancel()
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            cancelled = true;
+            spaceAvailable.notify_one();
+        }
+
+        bool Succeeded()
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            return succeeded;
+        }
+
+    private:
+        std::mutex mutex;
+        std::condition_variable blockAvailable;
+        std::condition_variable spaceAvailable;
+        std::deque<std::vector<uint8_t>> blocks;
+        bool finished = false;
+        bool succeeded = false;
+        bool cancelled = false;
+    };
+
+    class Deflater
+    {
+    public:
+        explicit Deflater(BlockChannel &channel)
+            : channel(channel), initialized(false)
+        {
+            stream = z_stream();
+            // windowBits 15 + 16 gera o cabeçalho e o rodapé gzip em vez de zlib.
+            initialized = api.deflateInit2_(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8,
+                                            Z_DEFAULT_STRATEGY, ZLIB_VERSION, static_cast<int>(sizeof(z_stream))) == Z_OK;
+            output.resize(GzipStream::kBlockSize);
+        }
+
+        ~Deflater()
+        {
+            if (initialized)
+                api.deflateEnd(&stream);
+        }
+
+        bool IsValid() const { return initialized; }
+
+        bool Write(const uint8_t *data, size_t size)
+        {
+            // avail_in é de 32 bits; blocos maiores vão em partes.
+            while (size > 0)
+            {
+                uInt part = size > 0x40000000 ? 0x40000000 : static_cast<uInt>(size);
+                stream.next_in = const_cast<Bytef *>(data);
+                stream.avail_in = part;
+                if (!Run(Z_NO_FLUSH))
+                    return false;
+                data += part;
+                size -= part;
+            }
+            return true;
+        }
+
+        bool Finish()
+        {
+            stream.next_in = nullptr;
+            stream.avail_in = 0;
+            if (!Run(Z_FINISH))
+                return false;
+            size_t used = GzipStream::kBlockSize - stream.avail_out;
+            if (used == 0)
+                return true;
+            output.resize(used);
+            return channel.Push(std::move(output));
+        }
+
+    private:
+        bool Run(int flush)
+        {
+            for (;;)
+            {
+                if (output.size() != GzipStream::kBlockSize)
+                    output.resize(GzipStream::kBlockSize);
+                if (stream.avail_out == 0 || stream.next_out == nullptr)
+                {
+                    stream.next_out = output.data();
+                    stream.avail_out = static_cast<uInt>(output.size());
+                }
+
+                int result = api.deflate(&stream, flush);
+                if (result == Z_STREAM_ERROR)
+                    return false;
+
+                if (stream.avail_out == 0)
+                {
+                    // Bloco cheio: vai para a fila e o deflate segue num novo.
+                    if (!channel.Push(std::move(output)))
+                        return false;
+                    output = std::vector<uint8_t>(GzipStream::kBlockSize);
+                    stream.next_out = nullptr;
+                    continue;
+                }
+                if (flush == Z_FINISH ? result == Z_STREAM_END : stream.avail_in == 0)
+                    return true;
+            }
+        }
+
+        BlockChannel &channel;
+        z_stream stream;
+        bool initialized;
+        std::vector<uint8_t> output;
+    };
+}
+
+bool GzipStream::IsAvailable()
+{
+    std::call_once(loadOnce, Load);
+    return loaded;
+}
+
+bool GzipStream::Pipe(const DocumentProducer &produce, const ChunkWriter &send)
+{
+    if (!IsAvailable())
+        return false;
+
+    BlockChannel channel;
+    uint64_t traceJobId = TraceJobScope::CurrentJobId();
+    const std::string &tracePrinter = TraceJobScope::CurrentPrinter();
+
+    std::thread deflateThread([&]
+                              {
+        TraceJobScope traceJob(traceJobId, tracePrinter);
+        TraceSpan span("deflate");
+        bool ok = false;
+        try
+        {
+            Deflater deflater(channel);
+            ok = deflater.IsValid() &&
+                 produce([&deflater](const uint8_t *data, size_t size)
+                         { return deflater.Write(data, size); }) &&
+                 deflater.Finish();
+        }
+        catch (...)
+        {
+            ok = false;
+        }
+        channel.Finish(ok); });
+
+    bool sent = true;
+    std::vector<uint8_t> block;
+    while (channel.Pop(block))
+    {
+        if (!send(block.data(), block.size()))
+        {
+            sent = false;
+            channel.Cancel();
+            break;
+        }
+    }
+
+    deflateThread.join();
+    return sent && channel.Succeeded();
+}
@@ -0,0 +1,28 @@
+#ifndef GZIP_STREAM_H
+#define GZIP_STREAM_H
+
+#include "printer_interface.h"
+
+// Compressão gzip de documentos para envio ao servidor de impressão.
+//
+// O produtor e o deflate rodam numa thread separada; os blocos já
+// comprimidos passam por uma fila curta e são enviados na thread que chamou,
+// que é a dona da conexão HTTP. Assim a compressão de um bloco acontece
+// enquanto o anterior ainda está na rede.
+//
+// A zlib é carregada com dlopen no primeiro uso, como a libcups.
+class GzipStream
+{
+public:
+    static constexpr size_t kBlockSize = 64 * 1024;
+    // Blocos comprimidos aguardando envio antes de o deflate esperar.
+    static constexpr size_t kMaxPendingBlocks = 8;
+
+    static bool IsAvailable();
+
+    // Gera o documento com produce e entrega a versão gzip a send. Retorna
+    // false se o produtor, a compressão ou o envio falharem.
+    static bool Pipe(const DocumentProducer &produce, const ChunkWriter &send);
+};
+
+#endif
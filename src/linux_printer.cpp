@@ -1,7 +1,22 @@
 #include "linux_printer.h"
+#include "cups_loader.h"
+#include "gzip_stream.h"
+#include "trace.h"
+#include <cstring>
 #include <cups/cups.h>
 #include <cups/ppd.h>
 
+namespace
+{
+    // successful-ok, successful-ok-ignored-or-substituted-attributes e
+    // successful-ok-conflicting-attributes: o documento foi aceito. Abaixo de
+    // IPP_STATUS_OK fica IPP_STATUS_CUPS_INVALID, devolvido em erro de transporte.
+    bool IsIppSuccess(ipp_status_t status)
+    {
+        return status >= IPP_STATUS_OK && status <= IPP_STATUS_OK_CONFLICTING;
+    }
+}
+
 std::string LinuxPrinter::GetPrinterStatus(ipp_pstate_t state)
 {
     switch (state)
@@ -17,15 +32,24 @@ std::string LinuxPrinter::GetPrinterStatus(ipp_pstate_t state)
     }
 }
 
+bool LinuxPrinter::IsAvailable()
+{
+    return CupsApi::IsAvailable();
+}
+
 PrinterInfo LinuxPrinter::GetPrinterDetails(const std::string &printerName, bool isDefault)
 {
+    const CupsApi &cups = CupsApi::Get();
+    TraceJobScope traceJob(TraceJobScope::CurrentJobId(), printerName);
+    TraceSpan span("GetPrinterDetails");
+
     PrinterInfo info;
     info.name = printerName;
     info.isDefault = isDefault;
 
     cups_dest_t *dests;
-    int num_dests = cupsGetDests(&dests);
-    cups_dest_t *dest = cupsGetDest(printerName.c_str(), NULL, num_dests, dests);
+    int num_dests = cups.cupsGetDests(&dests);
+    cups_dest_t *dest = cups.cupsGetDest(printerName.c_str(), NULL, num_dests, dests);
 
     if (dest != NULL)
     {
@@ -34,74 +58,93 @@ PrinterInfo LinuxPrinter::GetPrinterDetails(const std::string &printerName, bool
             info.details[dest->options[i].name] = dest->options[i].value;
         }
 
-        http_t *http = httpConnect2(cupsServer(), ippPort(), NULL, AF_UNSPEC,
-                                    HTTP_ENCRYPTION_IF_REQUESTED, 1, 30000, NULL);
+        http_t *http = cups.httpConnect2(cups.cupsServer(), cups.ippPort(), NULL, AF_UNSPEC,
+                                         HTTP_ENCRYPTION_IF_REQUESTED, 1, 30000, NULL);
         if (http != NULL)
         {
-            ipp_t *request = ippNewRequest(IPP_OP_GET_PRINTER_ATTRIBUTES);
+            ipp_t *request = cups.ippNewRequest(IPP_OP_GET_PRINTER_ATTRIBUTES);
 
             char uri[HTTP_MAX_URI];
-            httpAssembleURIf(HTTP_URI_CODING_ALL, uri, sizeof(uri), "ipp", NULL,
-                             "localhost", 0, "/printers/%s", printerName.c_str());
+            cups.httpAssembleURIf(HTTP_URI_CODING_ALL, uri, sizeof(uri), "ipp", NULL,
+                                  "localhost", 0, "/printers/%s", printerName.c_str());
 
-            ippAddString(request, IPP_TAG_OPERATION, IPP_TAG_URI,
-                         "printer-uri", NULL, uri);
+            cups.ippAddString(request, IPP_TAG_OPERATION, IPP_TAG_URI,
+                              "printer-uri", NULL, uri);
 
-            ipp_t *response = cupsDoRequest(http, request, "/");
+            ipp_t *response = cups.cupsDoRequest(http, request, "/");
             if (response != NULL)
             {
-                ipp_attribute_t *attr = ippFindAttribute(response,
-                                                         "printer-state", IPP_TAG_ENUM);
+                ipp_attribute_t *attr = cups.ippFindAttribute(response,
+                                                              "printer-state", IPP_TAG_ENUM);
+                if (attr != NULL)
+                {
+                    info.status = GetPrinterStatus((ipp_pstate_t)cups.ippGetInteger(attr, 0));
+                }
+
+                attr = cups.ippFindAttribute(response, "printer-state-reasons", IPP_TAG_KEYWORD);
                 if (attr != NULL)
                 {
-                    info.status = GetPrinterStatus((ipp_pstate_t)ippGetInteger(attr, 0));
+                    PrinterState state;
+                    int count = cups.ippGetCount(attr);
+                    for (int i = 0; i < count; i++)
+                    {
+                        const char *keyword = cups.ippGetString(attr, i, NULL);
+                        if (keyword != NULL)
+                            PrinterStateDecoder::AddKeyword(keyword, state);
+                    }
+                    info.stateReasons = state.reasons;
+                    info.stateSeverity = state.severity;
                 }
 
-                attr = ippFindAttribute(response, "printer-location", IPP_TAG_TEXT);
+                attr = cups.ippFindAttribute(response, "printer-location", IPP_TAG_TEXT);
                 if (attr != NULL)
-                    info.details["location"] = ippGetString(attr, 0, NULL);
+                    info.details["location"] = cups.ippGetString(attr, 0, NULL);
 
-                attr = ippFindAttribute(response, "printer-info", IPP_TAG_TEXT);
+                attr = cups.ippFindAttribute(response, "printer-info", IPP_TAG_TEXT);
                 if (attr != NULL)
-                    info.details["comment"] = ippGetString(attr, 0, NULL);
+                    info.details["comment"] = cups.ippGetString(attr, 0, NULL);
 
-                attr = ippFindAttribute(response, "printer-make-and-model", IPP_TAG_TEXT);
+                attr = cups.ippFindAttribute(response, "printer-make-and-model", IPP_TAG_TEXT);
                 if (attr != NULL)
-                    info.details["driver"] = ippGetString(attr, 0, NULL);
+                    info.details["driver"] = cups.ippGetString(attr, 0, NULL);
 
-                attr = ippFindAttribute(response, "port", IPP_TAG_TEXT);
+                attr = cups.ippFindAttribute(response, "port", IPP_TAG_TEXT);
                 if (attr != NULL)
-                    info.details["port"] = ippGetString(attr, 0, NULL);
+                    info.details["port"] = cups.ippGetString(attr, 0, NULL);
 
-                ippDelete(response);
+                cups.ippDelete(response);
             }
-            httpClose(http);
+            cups.httpClose(http);
         }
     }
-    cupsFreeDests(num_dests, dests);
+    cups.cupsFreeDests(num_dests, dests);
     return info;
 }
 
 std::vector<PrinterInfo> LinuxPrinter::GetPrinters()
 {
+    const CupsApi &cups = CupsApi::Get();
+
     std::vector<PrinterInfo> printers;
     cups_dest_t *dests;
-    int num_dests = cupsGetDests(&dests);
+    int num_dests = cups.cupsGetDests(&dests);
 
     for (int i = 0; i < num_dests; i++)
     {
         printers.push_back(GetPrinterDetails(dests[i].name, dests[i].is_default));
     }
 
-    cupsFreeDests(num_dests, dests);
+    cups.cupsFreeDests(num_dests, dests);
     return printers;
 }
 
 PrinterInfo LinuxPrinter::GetSystemDefaultPrinter()
 {
+    const CupsApi &cups = CupsApi::Get();
+
     cups_dest_t *dests;
-    int num_dests = cupsGetDests(&dests);
-    cups_dest_t *dest = cupsGetDest(NULL, NULL, num_dests, dests);
+    int num_dests = cups.cupsGetDests(&dests);
+    cups_dest_t *dest = cups.cupsGetDest(NULL, NULL, num_dests, dests);
 
     PrinterInfo printer;
     if (dest != NULL)
@@ -109,48 +152,207 @@ PrinterInfo LinuxPrinter::GetSystemDefaultPrinter()
         printer = GetPrinterDetails(dest->name, true);
     }
 
-    cupsFreeDests(num_dests, dests);
+    cups.cupsFreeDests(num_dests, dests);
     return printer;
 }
 
 bool LinuxPrinter::PrintDirect(const std::string &printerName,
                                const std::vector<uint8_t> &data,
-                               const std::string &dataType)
+                               const std::string &dataType,
+                               DocumentCompression compression)
+{
+    return PrintStream(
+               printerName, dataType, [&data](const ChunkWriter &write)
+               { return write(data.data(), data.size()); },
+               compression) == PrintOutcome::Printed;
+}
+
+bool LinuxPrinter::SupportsGzip(const std::string &printerName)
 {
-    int jobId = cupsCreateJob(CUPS_HTTP_DEFAULT, printerName.c_str(),
-                              "Node.js Print Job", 0, NULL);
+    {
+        std::lock_guard<std::mutex> lock(compressionMutex);
+        auto cached = gzipSupport.find(printerName);
+        if (cached != gzipSupport.end())
+            return cached->second;
+    }
 
-    if (jobId <= 0)
+    const CupsApi &cups = CupsApi::Get();
+    TraceSpan span("compression-supported");
+
+    ipp_t *request = cups.ippNewRequest(IPP_OP_GET_PRINTER_ATTRIBUTES);
+
+    char uri[HTTP_MAX_URI];
+    cups.httpAssembleURIf(HTTP_URI_CODING_ALL, uri, sizeof(uri), "ipp", NULL,
+                          "localhost", 0, "/printers/%s", printerName.c_str());
+    cups.ippAddString(request, IPP_TAG_OPERATION, IPP_TAG_URI,
+                      "printer-uri", NULL, uri);
+    cups.ippAddString(request, IPP_TAG_OPERATION, IPP_TAG_KEYWORD,
+                      "requested-attributes", NULL, "compression-supported");
+
+    ipp_t *response = cups.cupsDoRequest(CUPS_HTTP_DEFAULT, request, "/");
+    if (response == NULL)
         return false;
 
-    http_status_t status = cupsStartDocument(CUPS_HTTP_DEFAULT, printerName.c_str(),
-                                             jobId, "Node.js Print Job",
-                                             dataType.c_str(), 1);
+    bool supported = false;
+    ipp_attribute_t *attr = cups.ippFindAttribute(response, "compression-supported", IPP_TAG_KEYWORD);
+    int count = attr != NULL ? cups.ippGetCount(attr) : 0;
+    for (int i = 0; i < count && !supported; i++)
+    {
+        const char *value = cups.ippGetString(attr, i, NULL);
+        supported = value != NULL && strcmp(value, "gzip") == 0;
+    }
+    cups.ippDelete(response);
+
+    std::lock_guard<std::mutex> lock(compressionMutex);
+    gzipSupport[printerName] = supported;
+    return supported;
+}
+
+ipp_status_t LinuxPrinter::SendGzipDocument(const std::string &printerName,
+                                            int jobId,
+                                            const std::string &dataType,
+                                            const DocumentProducer &produce)
+{
+    const CupsApi &cups = CupsApi::Get();
+
+    // O mesmo pedido que cupsStartDocument monta, com o atributo compression.
+    char uri[HTTP_MAX_URI];
+    cups.httpAssembleURIf(HTTP_URI_CODING_ALL, uri, sizeof(uri), "ipp", NULL,
+                          "localhost", 0, "/printers/%s", printerName.c_str());
+    std::string resource = "/printers/" + printerName;
+
+    ipp_t *request = cups.ippNewRequest(IPP_OP_SEND_DOCUMENT);
+    cups.ippAddString(request, IPP_TAG_OPERATION, IPP_TAG_URI,
+                      "printer-uri", NULL, uri);
+    cups.ippAddInteger(request, IPP_TAG_OPERATION, IPP_TAG_INTEGER, "job-id", jobId);
+    cups.ippAddString(request, IPP_TAG_OPERATION, IPP_TAG_NAME,
+                      "requesting-user-name", NULL, cups.cupsUser());
+    cups.ippAddString(request, IPP_TAG_OPERATION, IPP_TAG_NAME,
+                      "document-name", NULL, "Node.js Print Job");
+    cups.ippAddString(request, IPP_TAG_OPERATION, IPP_TAG_KEYWORD,
+                      "compression", NULL, "gzip");
+    cups.ippAddString(request, IPP_TAG_OPERATION, IPP_TAG_MIMETYPE,
+                      "document-format", NULL, dataType.c_str());
+    cups.ippAddBoolean(request, IPP_TAG_OPERATION, "last-document", 1);
+
+    http_status_t status;
+    {
+        TraceSpan span("cupsSendRequest");
+        status = cups.cupsSendRequest(CUPS_HTTP_DEFAULT, request, resource.c_str(), CUPS_LENGTH_VARIABLE);
+    }
+    cups.ippDelete(request);
+
+    if (status == HTTP_STATUS_CONTINUE)
+    {
+        TraceSpan span("write");
+        bool written = GzipStream::Pipe(produce, [&cups](const uint8_t *chunk, size_t size)
+                                        { return cups.cupsWriteRequestData(CUPS_HTTP_DEFAULT,
+                                                                           reinterpret_cast<const char *>(chunk),
+                                                                           size) == HTTP_STATUS_CONTINUE; });
+        if (!written)
+            return IPP_STATUS_ERROR_INTERNAL;
+    }
+    else if (status != HTTP_STATUS_OK)
+    {
+        return IPP_STATUS_ERROR_SERVICE_UNAVAILABLE;
+    }
+
+    // Com HTTP_STATUS_OK o servidor respondeu antes do corpo (ex.: compression
+    // recusada); a resposta diz o motivo.
+    TraceSpan span("cupsGetResponse");
+    ipp_t *response = cups.cupsGetResponse(CUPS_HTTP_DEFAULT, resource.c_str());
+    ipp_status_t result = cups.cupsLastError();
+    if (response != NULL)
+        cups.ippDelete(response);
+    return result;
+}
+
+PrintOutcome LinuxPrinter::PrintStream(const std::string &printerName,
+                                       const std::string &dataType,
+                                       const DocumentProducer &produce,
+                                       DocumentCompression compression)
+{
+    const CupsApi &cups = CupsApi::Get();
+
+    // Só comprime quando a zlib existe e a fila anuncia gzip; nos outros casos
+    // o documento segue sem compressão, sem erro para o chamador.
+    bool gzip = compression == DocumentCompression::Gzip &&
+                GzipStream::IsAvailable() && SupportsGzip(printerName);
+
+    int jobId;
+    {
+        TraceSpan span("cupsCreateJob");
+        jobId = cups.cupsCreateJob(CUPS_HTTP_DEFAULT, printerName.c_str(),
+                                   "Node.js Print Job", 0, NULL);
+    }
+
+    if (jobId <= 0)
+        return PrintOutcome::NotSent;
+
+    if (gzip)
+    {
+        ipp_status_t result = SendGzipDocument(printerName, jobId, dataType, produce);
+        if (IsIppSuccess(result))
+            return PrintOutcome::Printed;
+        if (result != IPP_STATUS_ERROR_COMPRESSION_NOT_SUPPORTED &&
+            result != IPP_STATUS_ERROR_COMPRESSION_ERROR)
+        {
+            cups.cupsCancelJob(printerName.c_str(), jobId);
+            return PrintOutcome::NotSent;
+        }
+
+        // A fila anunciou gzip mas recusou o documento: lembra disso e reenvia
+        // sem compressão no mesmo trabalho, que ainda não tem documento.
+        std::lock_guard<std::mutex> lock(compressionMutex);
+        gzipSupport[printerName] = false;
+    }
+
+    http_status_t status;
+    {
+        TraceSpan span("cupsStartDocument");
+        status = cups.cupsStartDocument(CUPS_HTTP_DEFAULT, printerName.c_str(),
+                                        jobId, "Node.js Print Job",
+                                        dataType.c_str(), 1);
+    }
 
     if (status != HTTP_STATUS_CONTINUE)
     {
-        cupsCancelJob(printerName.c_str(), jobId);
-        return false;
+        cups.cupsCancelJob(printerName.c_str(), jobId);
+        return PrintOutcome::NotSent;
     }
 
-    if (cupsWriteRequestData(CUPS_HTTP_DEFAULT,
-                             reinterpret_cast<const char *>(data.data()),
-                             data.size()) != HTTP_STATUS_CONTINUE)
+    bool written;
     {
-        cupsCancelJob(printerName.c_str(), jobId);
-        return false;
+        TraceSpan span("write");
+        written = produce([&cups](const uint8_t *chunk, size_t size)
+                          { return cups.cupsWriteRequestData(CUPS_HTTP_DEFAULT,
+                                                             reinterpret_cast<const char *>(chunk),
+                                                             size) == HTTP_STATUS_CONTINUE; });
+    }
+    // O CUPS só processa o trabalho depois de receber o documento inteiro, então
+    // cancelar aqui garante que nada foi impresso.
+    if (!written)
+    {
+        cups.cupsCancelJob(printerName.c_str(), jobId);
+        return PrintOutcome::NotSent;
     }
 
-    status = static_cast<http_status_t>(cupsFinishDocument(CUPS_HTTP_DEFAULT, printerName.c_str()));
-    return status == HTTP_STATUS_OK;
+    // cupsFinishDocument devolve o status IPP da resposta, não o status HTTP.
+    // Um erro aqui não diz se o documento foi aceito.
+    TraceSpan span("cupsFinishDocument");
+    return IsIppSuccess(cups.cupsFinishDocument(CUPS_HTTP_DEFAULT, printerName.c_str()))
+               ? PrintOutcome::Printed
+               : PrintOutcome::Failed;
 }
 
 PrinterInfo LinuxPrinter::GetStatusPrinter(const std::string &printerName)
 {
+    const CupsApi &cups = CupsApi::Get();
+
     cups_dest_t *dests;
-    int num_dests = cupsGetDests(&dests);
+    int num_dests = cups.cupsGetDests(&dests);
 
-    cups_dest_t *defaultDest = cupsGetDest(NULL, NULL, num_dests, dests);
+    cups_dest_t *defaultDest = cups.cupsGetDest(NULL, NULL, num_dests, dests);
     bool isDefault = false;
 
     if (defaultDest != NULL)
@@ -158,7 +360,7 @@ PrinterInfo LinuxPrinter::GetStatusPrinter(const std::string &printerName)
         isDefault = (printerName == defaultDest->name);
     }
 
-    cups_dest_t *dest = cupsGetDest(printerName.c_str(), NULL, num_dests, dests);
+    cups_dest_t *dest = cups.cupsGetDest(printerName.c_str(), NULL, num_dests, dests);
     PrinterInfo printer;
 
     if (dest != NULL)
@@ -166,6 +368,6 @@ PrinterInfo LinuxPrinter::GetStatusPrinter(const std::string &printerName)
         printer = GetPrinterDetails(printerName, isDefault);
     }
 
-    cupsFreeDests(num_dests, dests);
+    cups.cupsFreeDests(num_dests, dests);
     return printer;
 }
\ No newline at end of file
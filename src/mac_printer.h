@@ -4,19 +4,32 @@
 #include <cups/cups.h>
 #include <cups/ppd.h>
 #include <cstdint>
+#include <map>
+#include <mutex>
 #include "printer_interface.h"
 
 class MacPrinter : public PrinterInterface
 {
 private:
+    // compression-supported de cada fila, consultado uma vez por processo.
+    std::mutex compressionMutex;
+    std::map<std::string, bool> gzipSupport;
+
     std::string GetPrinterStatus(ipp_pstate_t state);
+    bool SupportsGzip(const std::string &printerName);
+    ipp_status_t SendGzipDocument(const std::string &printerName, int jobId,
+                                  const std::string &dataType, const DocumentProducer &produce);
 
 public:
+    virtual bool IsAvailable() override;
     virtual PrinterInfo GetPrinterDetails(const std::string &printerName, bool isDefault = false) override;
     virtual std::vector<PrinterInfo> GetPrinters() override;
     virtual PrinterInfo GetSystemDefaultPrinter() override;
-    virtual bool PrintDirect(const std::string &printerName, const std::vector<uint8_t> &data, const std::string &dataType) override;
+    virtual bool PrintDirect(const std::string &printerName, const std::vector<uint8_t> &data, const std::string &dataType,
+                             DocumentCompression compression = DocumentCompression::None) override;
     virtual PrinterInfo GetStatusPrinter(const std::string &printerName) override;
+    virtual PrintOutcome PrintStream(const std::string &printerName, const std::string &dataType, const DocumentProducer &produce,
+                                     DocumentCompression compression = DocumentCompression::None) override;
 };
 
 #endif 
\ No newline at end of file
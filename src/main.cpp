@@ -1,13 +1,29 @@
 #include <napi.h>
-#include "printer_factory.h"
+#include "addon_context.h"
 
 Napi::Value PrintDirect(const Napi::CallbackInfo &info);
 Napi::Value GetPrinters(const Napi::CallbackInfo &info);
 Napi::Value GetSystemDefaultPrinter(const Napi::CallbackInfo &info);
 Napi::Value GetStatusPrinter(const Napi::CallbackInfo &info);
+Napi::Value ReadPrinterCache(const Napi::CallbackInfo &info);
+Napi::Value PrintRaster(const Napi::CallbackInfo &info);
+Napi::Value SetCoalescing(const Napi::CallbackInfo &info);
+Napi::Value SetQueueLimits(const Napi::CallbackInfo &info);
+Napi::Value GetQueueInfo(const Napi::CallbackInfo &info);
+Napi::Value GetRawStatus(const Napi::CallbackInfo &info);
+Napi::Value CloseRawStatus(const Napi::CallbackInfo &info);
+Napi::Value SetTracing(const Napi::CallbackInfo &info);
+Napi::Value DumpTrace(const Napi::CallbackInfo &info);
+Napi::Value IsPrintingAvailable(const Napi::CallbackInfo &info);
+Napi::Value GetNativeStats(const Napi::CallbackInfo &info);
+Napi::Value EncodeRaster(const Napi::CallbackInfo &info);
+Napi::Value DecodeStateReasons(const Napi::CallbackInfo &info);
+Napi::Object CreateStateReasonFlags(Napi::Env env);
 
 Napi::Object Init(Napi::Env env, Napi::Object exports)
 {
+    AddonContext::Init(env);
+
     exports.Set(Napi::String::New(env, "printDirect"),
                 Napi::Function::New(env, PrintDirect));
     exports.Set(Napi::String::New(env, "getPrinters"),
@@ -16,6 +32,34 @@ Napi::Object Init(Napi::Env env, Napi::Object exports)
                 Napi::Function::New(env, GetSystemDefaultPrinter));
     exports.Set(Napi::String::New(env, "getStatusPrinter"),
                 Napi::Function::New(env, GetStatusPrinter));
+    exports.Set(Napi::String::New(env, "readPrinterCache"),
+                Napi::Function::New(env, ReadPrinterCache));
+    exports.Set(Napi::String::New(env, "printRaster"),
+                Napi::Function::New(env, PrintRaster));
+    exports.Set(Napi::String::New(env, "encodeRaster"),
+                Napi::Function::New(env, EncodeRaster));
+    exports.Set(Napi::String::New(env, "setCoalescing"),
+                Napi::Function::New(env, SetCoalescing));
+    exports.Set(Napi::String::New(env, "setQueueLimits"),
+                Napi::Function::New(env, SetQueueLimits));
+    exports.Set(Napi::String::New(env, "getQueueInfo"),
+                Napi::Function::New(env, GetQueueInfo));
+    exports.Set(Napi::String::New(env, "getRawStatus"),
+                Napi::Function::New(env, GetRawStatus));
+    exports.Set(Napi::String::New(env, "closeRawStatus"),
+                Napi::Function::New(env, CloseRawStatus));
+    exports.Set(Napi::String::New(env, "setTracing"),
+                Napi::Function::New(env, SetTracing));
+    exports.Set(Napi::String::New(env, "dumpTrace"),
+                Napi::Function::New(env, DumpTrace));
+    exports.Set(Napi::String::New(env, "isPrintingAvailable"),
+                Napi::Function::New(env, IsPrintingAvailable));
+    exports.Set(Napi::String::New(env, "getNativeStats"),
+                Napi::Function::New(env, GetNativeStats));
+    exports.Set(Napi::String::New(env, "decodeStateReasons"),
+                Napi::Function::New(env, DecodeStateReasons));
+    exports.Set(Napi::String::New(env, "stateReasonFlags"),
+                CreateStateReasonFlags(env));
     return exports;
 }
 
@@ -0,0 +1,74 @@
+#include "mock_printer.h"
+
+namespace
+{
+    // Os mesmos nomes do bench/mock-ipp-server.js.
+    const char *const kPrinters[] = {"Mock-1", "Mock-2", "Mock-3", "Mock-4"};
+}
+
+bool MockPrinter::IsKnown(const std::string &printerName)
+{
+    for (const char *name : kPrinters)
+    {
+        if (printerName == name)
+            return true;
+    }
+    return false;
+}
+
+bool MockPrinter::IsAvailable()
+{
+    return true;
+}
+
+PrinterInfo MockPrinter::GetPrinterDetails(const std::string &printerName, bool isDefault)
+{
+    PrinterInfo info;
+    info.name = printerName;
+    info.isDefault = isDefault;
+    info.status = "ready";
+    info.details["location"] = "Bancada";
+    info.details["comment"] = printerName + " (simulada)";
+    info.details["driver"] = "Mock Printer";
+    info.details["port"] = "mock";
+    return info;
+}
+
+std::vector<PrinterInfo> MockPrinter::GetPrinters()
+{
+    std::vector<PrinterInfo> printers;
+    for (const char *name : kPrinters)
+    {
+        printers.push_back(GetPrinterDetails(name, name == kPrinters[0]));
+    }
+    return printers;
+}
+
+PrinterInfo MockPrinter::GetSystemDefaultPrinter()
+{
+    return GetPrinterDetails(kPrinters[0], true);
+}
+
+bool MockPrinter::PrintDirect(const std::string &printerName, const std::vector<uint8_t> &data, const std::string &dataType,
+                              DocumentCompression compression)
+{
+    return IsKnown(printerName);
+}
+
+PrinterInfo MockPrinter::GetStatusPrinter(const std::string &printerName)
+{
+    if (!IsKnown(printerName))
+        return PrinterInfo();
+    return GetPrinterDetails(printerName, printerName == kPrinters[0]);
+}
+
+PrintOutcome MockPrinter::PrintStream(const std::string &printerName, const std::string &dataType, const DocumentProducer &produce,
+                                      DocumentCompression compression)
+{
+    if (!IsKnown(printerName))
+        return PrintOutcome::NotSent;
+    return produce([](const uint8_t *, size_t)
+                   { return true; })
+               ? PrintOutcome::Printed
+               : PrintOutcome::NotSent;
+}
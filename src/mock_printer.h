@@ -0,0 +1,28 @@
+#ifndef MOCK_PRINTER_H
+#define MOCK_PRINTER_H
+
+#include <cstdint>
+#include "printer_interface.h"
+
+// Backend em memória, sem spooler do sistema. Responde na hora e descarta os
+// documentos, para medir o custo do próprio addon em testes e benchmarks.
+// Só existe nos binários compilados com node-gyp rebuild --mock-backend, onde
+// é ativado com PRINTER_ELECTRON_NODE_BACKEND=mock.
+class MockPrinter : public PrinterInterface
+{
+private:
+    static bool IsKnown(const std::string &printerName);
+
+public:
+    virtual bool IsAvailable() override;
+    virtual PrinterInfo GetPrinterDetails(const std::string &printerName, bool isDefault = false) override;
+    virtual std::vector<PrinterInfo> GetPrinters() override;
+    virtual PrinterInfo GetSystemDefaultPrinter() override;
+    virtual bool PrintDirect(const std::string &printerName, const std::vector<uint8_t> &data, const std::string &dataType,
+                             DocumentCompression compression = DocumentCompression::None) override;
+    virtual PrinterInfo GetStatusPrinter(const std::string &printerName) override;
+    virtual PrintOutcome PrintStream(const std::string &printerName, const std::string &dataType, const DocumentProducer &produce,
+                                     DocumentCompression compression = DocumentCompression::None) override;
+};
+
+#endif
@@ -1,91 +1,270 @@
 #include <napi.h>
-#include "printer_factory.h"
+#include "addon_context.h"
+#include "printer_cache.h"
+#include "raster_encoder.h"
+#include "trace.h"
+#include <atomic>
+#include <cctype>
+#include <stdexcept>
+#include <type_traits>
+
+// Workers nativos ainda vivos no processo. Os testes de carga conferem que o
+// número volta a zero quando a carga para.
+static std::atomic<int64_t> liveWorkers(0);
+
+struct LiveWorker
+{
+    LiveWorker() { liveWorkers++; }
+    ~LiveWorker() { liveWorkers--; }
+};
 
-class PrinterWorker : public Napi::AsyncWorker
+static bool ReadDecodeReasons(const Napi::Value &options)
 {
-private:
-    std::unique_ptr<PrinterInterface> printer;
-    std::function<void(PrinterWorker *)> work;
-    PrinterInfo printerResult;
-    std::vector<PrinterInfo> printersResult;
-    bool isMultiplePrinters;
-    bool success;
+    if (!options.IsObject())
+        return false;
+    Napi::Value value = options.As<Napi::Object>().Get("decodeReasons");
+    return value.IsBoolean() && value.As<Napi::Boolean>().Value();
+}
+
+static Napi::Array CreateReasonList(Napi::Env env, uint32_t reasons)
+{
+    std::vector<std::string> names = PrinterStateDecoder::Describe(reasons);
+    Napi::Array list = Napi::Array::New(env, names.size());
+    for (size_t i = 0; i < names.size(); i++)
+    {
+        list.Set(i, names[i]);
+    }
+    return list;
+}
+
+// O bitmask vai sempre como número; a lista de nomes só quando pedida, para
+// não alocar strings a cada consulta de status.
+static Napi::Object CreatePrinterObject(Napi::Env env, const PrinterInfo &printer, bool decodeReasons)
+{
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("name", printer.name);
+    result.Set("status", printer.status);
+    result.Set("isDefault", printer.isDefault);
+    result.Set("stateReasons", static_cast<double>(printer.stateReasons));
+    result.Set("stateSeverity", static_cast<double>(printer.stateSeverity));
+    if (decodeReasons)
+    {
+        result.Set("reasons", CreateReasonList(env, printer.stateReasons));
+    }
+
+    Napi::Object details = Napi::Object::New(env);
+    for (const auto &detail : printer.details)
+    {
+        details.Set(detail.first, detail.second);
+    }
+    result.Set("details", details);
+    return result;
+}
+
+// Resultados tipados das operações assíncronas. São preenchidos no pool do
+// libuv e convertidos para JS por ToJs na thread principal.
+struct PrinterResult
+{
+    PrinterInfo printer;
+    bool decodeReasons = false;
+};
+
+struct PrinterListResult
+{
+    std::vector<PrinterInfo> printers;
+    bool decodeReasons = false;
+};
+
+struct PrintResult
+{
+    std::string name;
+    bool success = false;
+};
+
+struct RasterResult
+{
+    std::vector<uint8_t> data;
+};
+
+struct RawStatusResult
+{
+    std::string target;
+    EscPosStatus status;
+};
+
+static Napi::Value ToJs(Napi::Env env, const PrinterResult &result)
+{
+    return CreatePrinterObject(env, result.printer, result.decodeReasons);
+}
+
+static Napi::Value ToJs(Napi::Env env, const PrinterListResult &result)
+{
+    Napi::Array list = Napi::Array::New(env, result.printers.size());
+    for (size_t i = 0; i < result.printers.size(); i++)
+    {
+        list.Set(i, CreatePrinterObject(env, result.printers[i], result.decodeReasons));
+    }
+    return list;
+}
+
+static Napi::Value ToJs(Napi::Env env, const PrintResult &result)
+{
+    Napi::Object output = Napi::Object::New(env);
+    output.Set("name", result.name);
+    output.Set("status", result.success ? "success" : "failed");
+    return output;
+}
+
+static Napi::Value ToJs(Napi::Env env, const RasterResult &result)
+{
+    return Napi::Buffer<uint8_t>::Copy(env, result.data.data(), result.data.size());
+}
+
+static Napi::Value ToJs(Napi::Env env, const RawStatusResult &result)
+{
+    const EscPosStatus &status = result.status;
+    Napi::Object output = Napi::Object::New(env);
+    output.Set("target", result.target);
+    output.Set("online", (status.flags & (ESCPOS_OFFLINE | ESCPOS_NO_RESPONSE)) == 0);
+    output.Set("flags", status.flags);
+    output.Set("asb", status.asb);
+    output.Set("ageMs", status.ageMs);
+    output.Set("latencyMs", status.latencyMs);
+
+    std::vector<std::string> names = EscPosStatusParser::Describe(status.flags);
+    Napi::Array conditions = Napi::Array::New(env, names.size());
+    for (size_t i = 0; i < names.size(); i++)
+    {
+        conditions.Set(i, names[i]);
+    }
+    output.Set("conditions", conditions);
+    return output;
+}
 
+static PrinterInterface *RequirePrinter(SharedResources *shared)
+{
+    if (!shared || !shared->GetPrinter())
+        throw std::runtime_error("Failed to create printer");
+    return shared->GetPrinter();
+}
+
+static Napi::Value ShuttingDownError(Napi::Env env)
+{
+    return Napi::Error::New(env, "Addon is shutting down").Value();
+}
+
+// Operação assíncrona que devolve uma promise. O trabalho roda no pool do
+// libuv e OnOK/OnError resolvem o Deferred direto, sem criar uma função JS por
+// chamada só para repassar o resultado. Exceções lançadas pelo trabalho
+// rejeitam a promise com a mensagem delas.
+template <typename Work>
+class PromiseWorker : public Napi::AsyncWorker
+{
 public:
-    PrinterWorker(Napi::Function &callback, std::function<void(PrinterWorker *)> executeWork)
-        : Napi::AsyncWorker(callback),
-          work(executeWork),
-          isMultiplePrinters(false),
-          success(false)
+    using Result = std::invoke_result_t<Work &, SharedResources *>;
+
+    PromiseWorker(Napi::Env env, const char *traceName, const std::string &tracePrinter, Work &&work)
+        : Napi::AsyncWorker(env, traceName),
+          deferred(Napi::Promise::Deferred::New(env)),
+          shared(AddonContext::Get(env)->GetShared()),
+          work(std::move(work)),
+          traceName(traceName),
+          tracePrinter(tracePrinter),
+          traceId(Trace::NextJobId())
     {
-        printer = PrinterFactory::Create();
+        if (traceId)
+            queuedAt = Trace::Clock::now();
     }
 
+    Napi::Promise Promise() const { return deferred.Promise(); }
+
     void Execute() override
     {
-        if (printer)
-        {
-            work(this);
-        }
-        else
-        {
-            SetError("Failed to create printer");
-        }
+        TraceJobScope job(traceId, tracePrinter);
+        if (traceId)
+            Trace::Record("queue-wait", tracePrinter, traceId, queuedAt, Trace::Clock::now());
+        TraceSpan span(traceName);
+
+        result = work(shared.get());
     }
 
     void OnOK() override
     {
         Napi::Env env = Env();
         Napi::HandleScope scope(env);
+        TraceJobScope job(traceId, tracePrinter);
+        TraceSpan span("OnOK");
 
-        if (isMultiplePrinters)
-        {
-            Napi::Array result = Napi::Array::New(env, printersResult.size());
-            for (size_t i = 0; i < printersResult.size(); i++)
-            {
-                result.Set(i, CreatePrinterObject(env, printersResult[i]));
-            }
-            Callback().Call({env.Null(), result});
-        }
-        else
-        {
-            Callback().Call({env.Null(), CreatePrinterObject(env, printerResult)});
-        }
+        deferred.Resolve(ToJs(env, result));
     }
 
-    PrinterInterface *GetPrinter() { return printer.get(); }
-    void SetPrinterResult(const PrinterInfo &result) { printerResult = result; }
-    void SetPrintersResult(const std::vector<PrinterInfo> &result)
+    void OnError(const Napi::Error &error) override
     {
-        printersResult = result;
-        isMultiplePrinters = true;
+        Napi::HandleScope scope(Env());
+        deferred.Reject(error.Value());
     }
-    void SetSuccess(bool value) { success = value; }
-    bool GetSuccess() const { return success; }
 
 private:
-    Napi::Object CreatePrinterObject(Napi::Env env, const PrinterInfo &printer)
+    LiveWorker live;
+    Napi::Promise::Deferred deferred;
+    std::shared_ptr<SharedResources> shared;
+    Work work;
+    const char *traceName;
+    std::string tracePrinter;
+    uint64_t traceId;
+    Trace::Clock::time_point queuedAt;
+    Result result;
+};
+
+// Enfileira o trabalho e devolve a promise que ele vai resolver.
+template <typename Work>
+static Napi::Promise QueuePromise(Napi::Env env, const char *traceName, const std::string &tracePrinter, Work work)
+{
+    if (AddonContext::Get(env)->IsClosing())
     {
-        Napi::Object result = Napi::Object::New(env);
-        result.Set("name", printer.name);
-        result.Set("status", printer.status);
+        Napi::Promise::Deferred deferred = Napi::Promise::Deferred::New(env);
+        deferred.Reject(ShuttingDownError(env));
+        return deferred.Promise();
+    }
 
-        // Só incluir estes campos se NÃO for um resultado do PrintDirect
-        if (!success)
-        { // Se success for true, é um PrintDirect
-            result.Set("isDefault", printer.isDefault);
+    auto worker = new PromiseWorker<Work>(env, traceName, tracePrinter, std::move(work));
+    Napi::Promise promise = worker->Promise();
+    worker->Queue();
+    return promise;
+}
 
-            Napi::Object details = Napi::Object::New(env);
-            for (const auto &detail : printer.details)
-            {
-                details.Set(detail.first, detail.second);
-            }
-            result.Set("details", details);
-        }
+static Napi::Value QueueFullError(Napi::Env env, const std::string &printerName)
+{
+    Napi::Error error = Napi::Error::New(env, "Print queue for '" + printerName + "' is full");
+    error.Set("code", "EQUEUEFULL");
+    return error.Value();
+}
 
-        return result;
+static Napi::Error TooManyQueuesError(Napi::Env env, const std::string &printerName)
+{
+    Napi::Error error = Napi::Error::New(env, "Cannot create a print queue for '" + printerName + "': too many print queues");
+    error.Set("code", "EQUEUEFULL");
+    return error;
+}
+
+// Lê a opção compression; devolve false (com a exceção pendente) se o valor
+// não for reconhecido.
+static bool ParseCompression(Napi::Env env, const Napi::Object &options, DocumentCompression &compression)
+{
+    compression = DocumentCompression::None;
+    if (!options.Has("compression") || !options.Get("compression").IsString())
+        return true;
+
+    std::string value = options.Get("compression").As<Napi::String>().Utf8Value();
+    if (value == "gzip")
+        compression = DocumentCompression::Gzip;
+    else if (value != "none")
+    {
+        Napi::TypeError::New(env, "compression must be 'gzip' or 'none'").ThrowAsJavaScriptException();
+        return false;
     }
-};
+    return true;
+}
 
 Napi::Value PrintDirect(const Napi::CallbackInfo &info)
 {
@@ -97,6 +276,11 @@ Napi::Value PrintDirect(const Napi::CallbackInfo &info)
         return env.Null();
     }
 
+    bool tracing = Trace::IsEnabled();
+    Trace::Clock::time_point convertStart;
+    if (tracing)
+        convertStart = Trace::Clock::now();
+
     Napi::Object options = info[0].As<Napi::Object>();
 
     if (!options.Has("printerName") || !options.Has("data"))
@@ -105,9 +289,31 @@ Napi::Value PrintDirect(const Napi::CallbackInfo &info)
         return env.Null();
     }
 
-    if (!options.Get("printerName").IsString())
+    // Com uma lista de impressoras o mesmo payload vai para todas, e o
+    // retorno é um array com uma promise por impressora.
+    Napi::Value printerNameValue = options.Get("printerName");
+    bool fanOut = printerNameValue.IsArray();
+    std::vector<std::string> printerNames;
+    if (fanOut)
     {
-        Napi::TypeError::New(env, "printerName must be a string").ThrowAsJavaScriptException();
+        Napi::Array names = printerNameValue.As<Napi::Array>();
+        for (uint32_t i = 0; i < names.Length(); i++)
+        {
+            if (!names.Get(i).IsString())
+            {
+                Napi::TypeError::New(env, "printerName must be a string or an array of strings").ThrowAsJavaScriptException();
+                return env.Null();
+            }
+            printerNames.push_back(names.Get(i).As<Napi::String>().Utf8Value());
+        }
+    }
+    else if (printerNameValue.IsString())
+    {
+        printerNames.push_back(printerNameValue.As<Napi::String>().Utf8Value());
+    }
+    else
+    {
+        Napi::TypeError::New(env, "printerName must be a string or an array of strings").ThrowAsJavaScriptException();
         return env.Null();
     }
 
@@ -118,18 +324,29 @@ Napi::Value PrintDirect(const Napi::CallbackInfo &info)
         return env.Null();
     }
 
-    std::string printerName = options.Get("printerName").As<Napi::String>().Utf8Value();
-    std::vector<uint8_t> printData;
-
-    if (data.IsString())
+    JobPriority priority = PRIORITY_NORMAL;
+    if (options.Has("priority") && options.Get("priority").IsString())
     {
-        std::string strData = data.As<Napi::String>().Utf8Value();
-        printData.assign(strData.begin(), strData.end());
+        std::string value = options.Get("priority").As<Napi::String>().Utf8Value();
+        if (value == "high")
+            priority = PRIORITY_HIGH;
+        else if (value == "bulk")
+            priority = PRIORITY_BULK;
+        else if (value != "normal")
+        {
+            Napi::TypeError::New(env, "priority must be 'high', 'normal' or 'bulk'").ThrowAsJavaScriptException();
+            return env.Null();
+        }
     }
-    else
+
+    auto deadline = std::chrono::steady_clock::time_point::max();
+    if (options.Has("timeoutMs") && options.Get("timeoutMs").IsNumber())
     {
-        Napi::Buffer<uint8_t> buffer = data.As<Napi::Buffer<uint8_t>>();
-        printData.assign(buffer.Data(), buffer.Data() + buffer.Length());
+        int64_t timeoutMs = options.Get("timeoutMs").As<Napi::Number>().Int64Value();
+        if (timeoutMs > 0)
+        {
+            deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+        }
     }
 
     std::string dataType = "RAW";
@@ -138,83 +355,306 @@ Napi::Value PrintDirect(const Napi::CallbackInfo &info)
         dataType = options.Get("dataType").As<Napi::String>().Utf8Value();
     }
 
-    Napi::Promise::Deferred deferred = Napi::Promise::Deferred::New(env);
+    DocumentCompression compression;
+    if (!ParseCompression(env, options, compression))
+    {
+        return env.Null();
+    }
+
+    std::string strData;
+    size_t dataSize;
+    if (data.IsString())
+    {
+        strData = data.As<Napi::String>().Utf8Value();
+        dataSize = strData.size();
+    }
+    else
+    {
+        dataSize = data.As<Napi::Buffer<uint8_t>>().Length();
+    }
+
+    // Recusa antes de copiar o payload, para a fila cheia não custar memória.
+    // A cópia é feita uma única vez e compartilhada por todas as filas.
+    AddonContext *context = AddonContext::Get(env);
+    std::shared_ptr<SharedResources> shared = context->GetShared();
+    bool closing = context->IsClosing();
 
-    auto callback = Napi::Function::New(env, [deferred](const Napi::CallbackInfo &info)
-                                        {
-        if (info[0].IsNull()) {
-            deferred.Resolve(info[1]);
-        } else {
-            deferred.Reject(info[0].As<Napi::Error>().Value());
+    std::vector<std::shared_ptr<PrintQueue>> queues;
+    std::vector<bool> noQueue;
+    PrintPayload payload;
+    for (const auto &printerName : printerNames)
+    {
+        std::shared_ptr<PrintQueue> queue = closing ? nullptr : shared->GetQueue(printerName);
+        noQueue.push_back(!closing && !queue);
+        if (queue && queue->HasRoom(dataSize))
+        {
+            if (!payload)
+            {
+                if (data.IsString())
+                {
+                    payload = std::make_shared<const std::vector<uint8_t>>(strData.begin(), strData.end());
+                }
+                else
+                {
+                    Napi::Buffer<uint8_t> buffer = data.As<Napi::Buffer<uint8_t>>();
+                    payload = std::make_shared<const std::vector<uint8_t>>(buffer.Data(), buffer.Data() + buffer.Length());
+                }
+            }
         }
-        return info.Env().Undefined(); });
+        else
+        {
+            queue.reset();
+        }
+        queues.push_back(queue);
+    }
 
-    auto worker = new PrinterWorker(
-        callback,
-        [printerName, printData, dataType](PrinterWorker *worker)
+    std::shared_ptr<PendingJobs> pending = context->GetPendingJobs();
+    Napi::Array promises = Napi::Array::New(env, printerNames.size());
+    for (size_t i = 0; i < printerNames.size(); i++)
+    {
+        Napi::Promise::Deferred deferred = Napi::Promise::Deferred::New(env);
+        promises.Set(i, deferred.Promise());
+        if (!queues[i])
         {
-            bool success = worker->GetPrinter()->PrintDirect(printerName, printData, dataType);
-            worker->SetSuccess(true); // Indica que é um resultado do PrintDirect
-            PrinterInfo result;
-            result.name = printerName;
-            result.status = success ? "success" : "failed";
-            worker->SetPrinterResult(result);
-        });
+            if (closing)
+                deferred.Reject(ShuttingDownError(env));
+            else if (noQueue[i])
+                deferred.Reject(TooManyQueuesError(env, printerNames[i]).Value());
+            else
+                deferred.Reject(QueueFullError(env, printerNames[i]));
+            continue;
+        }
 
-    worker->Queue();
-    return deferred.Promise();
+        uint64_t id = pending->Add(deferred);
+        PrintJob job(pending, id);
+        job.data = payload;
+        job.dataType = dataType;
+        job.compression = compression;
+        job.priority = priority;
+        job.deadline = deadline;
+        job.traceId = Trace::NextJobId();
+        uint64_t traceId = job.traceId;
+
+        if (!queues[i]->Push(std::move(job)))
+        {
+            pending->Remove(id);
+            deferred.Reject(QueueFullError(env, printerNames[i]));
+            continue;
+        }
+        if (tracing && traceId)
+        {
+            Trace::Record("convert", printerNames[i], traceId, convertStart, Trace::Clock::now());
+        }
+    }
+
+    if (fanOut)
+    {
+        return promises;
+    }
+    return promises.Get(uint32_t(0));
+}
+
+Napi::Value SetCoalescing(const Napi::CallbackInfo &info)
+{
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsObject())
+    {
+        Napi::TypeError::New(env, "Expected an object as argument").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    Napi::Object options = info[0].As<Napi::Object>();
+
+    if (!options.Has("printerName") || !options.Get("printerName").IsString())
+    {
+        Napi::TypeError::New(env, "printerName must be a string").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    uint32_t windowMs = 0;
+    if (options.Has("windowMs") && options.Get("windowMs").IsNumber())
+    {
+        windowMs = options.Get("windowMs").As<Napi::Number>().Uint32Value();
+    }
+
+    size_t maxBytes = 0;
+    if (options.Has("maxBytes") && options.Get("maxBytes").IsNumber())
+    {
+        maxBytes = static_cast<size_t>(options.Get("maxBytes").As<Napi::Number>().Int64Value());
+    }
+
+    std::string printerName = options.Get("printerName").As<Napi::String>().Utf8Value();
+    std::shared_ptr<SharedResources> shared = AddonContext::Get(env)->GetShared();
+    if (shared)
+    {
+        std::shared_ptr<PrintQueue> queue = shared->GetQueue(printerName);
+        if (!queue)
+        {
+            TooManyQueuesError(env, printerName).ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        queue->SetCoalescing(windowMs, maxBytes);
+    }
+    return env.Undefined();
+}
+
+Napi::Value SetQueueLimits(const Napi::CallbackInfo &info)
+{
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsObject())
+    {
+        Napi::TypeError::New(env, "Expected an object as argument").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    Napi::Object options = info[0].As<Napi::Object>();
+
+    if (!options.Has("printerName") || !options.Get("printerName").IsString())
+    {
+        Napi::TypeError::New(env, "printerName must be a string").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    std::string printerName = options.Get("printerName").As<Napi::String>().Utf8Value();
+    std::shared_ptr<SharedResources> shared = AddonContext::Get(env)->GetShared();
+    if (!shared)
+    {
+        return env.Undefined();
+    }
+    std::shared_ptr<PrintQueue> queue = shared->GetQueue(printerName);
+    if (!queue)
+    {
+        TooManyQueuesError(env, printerName).ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    size_t maxJobs = PrintQueue::kDefaultMaxJobs;
+    if (options.Has("maxQueuedJobs") && options.Get("maxQueuedJobs").IsNumber())
+    {
+        maxJobs = static_cast<size_t>(options.Get("maxQueuedJobs").As<Napi::Number>().Int64Value());
+    }
+
+    size_t maxBytes = PrintQueue::kDefaultMaxBytes;
+    if (options.Has("maxQueuedBytes") && options.Get("maxQueuedBytes").IsNumber())
+    {
+        maxBytes = static_cast<size_t>(options.Get("maxQueuedBytes").As<Napi::Number>().Int64Value());
+    }
+
+    uint32_t agingMs = PrintQueue::kDefaultAgingMs;
+    if (options.Has("agingMs") && options.Get("agingMs").IsNumber())
+    {
+        agingMs = options.Get("agingMs").As<Napi::Number>().Uint32Value();
+    }
+
+    queue->SetLimits(maxJobs, maxBytes, agingMs);
+    return env.Undefined();
+}
+
+Napi::Value GetQueueInfo(const Napi::CallbackInfo &info)
+{
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsObject())
+    {
+        Napi::TypeError::New(env, "Expected an object as argument").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    Napi::Object options = info[0].As<Napi::Object>();
+
+    if (!options.Has("printerName") || !options.Get("printerName").IsString())
+    {
+        Napi::TypeError::New(env, "printerName must be a string").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    std::string printerName = options.Get("printerName").As<Napi::String>().Utf8Value();
+    std::shared_ptr<SharedResources> shared = AddonContext::Get(env)->GetShared();
+    std::shared_ptr<PrintQueue> queue = shared ? shared->FindQueue(printerName) : nullptr;
+
+    PrintQueueStats stats = {0, 0, 0, false, 0};
+    if (queue)
+    {
+        stats = queue->GetStats();
+    }
+
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("name", printerName);
+    result.Set("depth", static_cast<double>(stats.depth));
+    result.Set("bytes", static_cast<double>(stats.bytes));
+    result.Set("oldestAgeMs", stats.oldestAgeMs);
+    result.Set("printing", stats.printing);
+    result.Set("rejected", static_cast<double>(stats.rejected));
+    return result;
 }
 
 Napi::Value GetPrinters(const Napi::CallbackInfo &info)
 {
     Napi::Env env = info.Env();
-    Napi::Promise::Deferred deferred = Napi::Promise::Deferred::New(env);
-
-    auto callback = Napi::Function::New(env, [deferred](const Napi::CallbackInfo &info)
-                                        {
-        if (info[0].IsNull()) {
-            deferred.Resolve(info[1]);
-        } else {
-            deferred.Reject(info[0].As<Napi::Error>().Value());
+
+    std::string cachePath;
+    bool decodeReasons = info.Length() > 0 && ReadDecodeReasons(info[0]);
+    if (info.Length() > 0 && info[0].IsObject())
+    {
+        Napi::Object options = info[0].As<Napi::Object>();
+        if (options.Has("cachePath") && options.Get("cachePath").IsString())
+        {
+            cachePath = options.Get("cachePath").As<Napi::String>().Utf8Value();
         }
-        return info.Env().Undefined(); });
+    }
 
-    auto worker = new PrinterWorker(
-        callback,
-        [](PrinterWorker *worker)
+    return QueuePromise(
+        env,
+        "getPrinters",
+        std::string(),
+        [cachePath, decodeReasons](SharedResources *shared)
         {
-            auto printers = worker->GetPrinter()->GetPrinters();
-            worker->SetPrintersResult(printers);
+            PrinterListResult result{RequirePrinter(shared)->GetPrinters(), decodeReasons};
+            if (!cachePath.empty())
+            {
+                PrinterCache::Store(cachePath, result.printers);
+            }
+            return result;
         });
+}
 
-    worker->Queue();
-    return deferred.Promise();
+Napi::Value ReadPrinterCache(const Napi::CallbackInfo &info)
+{
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsString())
+    {
+        Napi::TypeError::New(env, "cachePath must be a string").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    // Leitura síncrona de propósito: o arquivo é pequeno e o objetivo é
+    // responder antes de qualquer consulta ao servidor de impressão.
+    bool decodeReasons = info.Length() > 1 && ReadDecodeReasons(info[1]);
+    std::vector<PrinterInfo> printers;
+    if (!PrinterCache::Load(info[0].As<Napi::String>().Utf8Value(), printers))
+    {
+        return env.Null();
+    }
+
+    return ToJs(env, PrinterListResult{std::move(printers), decodeReasons});
 }
 
 Napi::Value GetSystemDefaultPrinter(const Napi::CallbackInfo &info)
 {
     Napi::Env env = info.Env();
-    Napi::Promise::Deferred deferred = Napi::Promise::Deferred::New(env);
-
-    auto callback = Napi::Function::New(env, [deferred](const Napi::CallbackInfo &info)
-                                        {
-        if (info[0].IsNull()) {
-            deferred.Resolve(info[1]);
-        } else {
-            deferred.Reject(info[0].As<Napi::Error>().Value());
-        }
-        return info.Env().Undefined(); });
+    bool decodeReasons = info.Length() > 0 && ReadDecodeReasons(info[0]);
 
-    auto worker = new PrinterWorker(
-        callback,
-        [](PrinterWorker *worker)
+    return QueuePromise(
+        env,
+        "getDefaultPrinter",
+        std::string(),
+        [decodeReasons](SharedResources *shared)
         {
-            auto printer = worker->GetPrinter()->GetSystemDefaultPrinter();
-            worker->SetPrinterResult(printer);
+            return PrinterResult{RequirePrinter(shared)->GetSystemDefaultPrinter(), decodeReasons};
         });
-
-    worker->Queue();
-    return deferred.Promise();
 }
 
 Napi::Value GetStatusPrinter(const Napi::CallbackInfo &info)
@@ -229,12 +669,6 @@ Napi::Value GetStatusPrinter(const Napi::CallbackInfo &info)
 
     Napi::Object options = info[0].As<Napi::Object>();
 
-    Napi::Array propertyNames = options.GetPropertyNames();
-    for (uint32_t i = 0; i < propertyNames.Length(); i++)
-    {
-        propertyNames.Get(i).As<Napi::String>();
-    }
-
     if (!options.Has("printerName"))
     {
         Napi::TypeError::New(env, "Object must have 'printerName' property").ThrowAsJavaScriptException();
@@ -248,25 +682,326 @@ Napi::Value GetStatusPrinter(const Napi::CallbackInfo &info)
     }
 
     std::string printerName = options.Get("printerName").As<Napi::String>().Utf8Value();
-    Napi::Promise::Deferred deferred = Napi::Promise::Deferred::New(env);
-
-    auto callback = Napi::Function::New(env, [deferred](const Napi::CallbackInfo &info)
-                                        {
-        if (info[0].IsNull()) {
-            deferred.Resolve(info[1]);
-        } else {
-            deferred.Reject(info[0].As<Napi::Error>().Value());
+    bool decodeReasons = ReadDecodeReasons(options);
+
+    return QueuePromise(
+        env,
+        "getStatusPrinter",
+        printerName,
+        [printerName, decodeReasons](SharedResources *shared)
+        {
+            return PrinterResult{RequirePrinter(shared)->GetStatusPrinter(printerName), decodeReasons};
+        });
+}
+
+// Os pixels não são copiados: cada página aponta para o Buffer do JS, que
+// fica referenciado em buffers até o worker terminar. A referência é solta no
+// destrutor do worker, que roda na thread principal.
+using BufferReference = Napi::Reference<Napi::Buffer<uint8_t>>;
+
+static bool ParseRasterOptions(Napi::Env env, const Napi::Object &options, std::vector<RasterPage> &pages,
+                               std::vector<BufferReference> &buffers, RasterOptions &rasterOptions)
+{
+    if (!options.Has("pages") || !options.Get("pages").IsArray())
+    {
+        Napi::TypeError::New(env, "pages must be an array").ThrowAsJavaScriptException();
+        return false;
+    }
+
+    Napi::Array pageList = options.Get("pages").As<Napi::Array>();
+    if (pageList.Length() == 0)
+    {
+        Napi::TypeError::New(env, "pages must not be empty").ThrowAsJavaScriptException();
+        return false;
+    }
+
+    for (uint32_t i = 0; i < pageList.Length(); i++)
+    {
+        Napi::Value item = pageList.Get(i);
+        if (!item.IsObject())
+        {
+            Napi::TypeError::New(env, "Each page must be an object").ThrowAsJavaScriptException();
+            return false;
         }
-        return info.Env().Undefined(); });
 
-    auto worker = new PrinterWorker(
-        callback,
-        [printerName](PrinterWorker *worker)
+        Napi::Object page = item.As<Napi::Object>();
+        if (!page.Get("width").IsNumber() || !page.Get("height").IsNumber() || !page.Get("data").IsBuffer())
+        {
+            Napi::TypeError::New(env, "Each page must have numeric 'width', 'height' and a Buffer 'data'").ThrowAsJavaScriptException();
+            return false;
+        }
+
+        RasterPage raster;
+        raster.width = page.Get("width").As<Napi::Number>().Uint32Value();
+        raster.height = page.Get("height").As<Napi::Number>().Uint32Value();
+        Napi::Buffer<uint8_t> buffer = page.Get("data").As<Napi::Buffer<uint8_t>>();
+
+        size_t pixels = static_cast<size_t>(raster.width) * raster.height;
+        if (pixels == 0)
+        {
+            Napi::TypeError::New(env, "Page width and height must be positive").ThrowAsJavaScriptException();
+            return false;
+        }
+
+        raster.channels = page.Get("channels").IsNumber()
+                              ? page.Get("channels").As<Napi::Number>().Uint32Value()
+                              : static_cast<uint32_t>(buffer.Length() / pixels);
+        if ((raster.channels != 1 && raster.channels != 3 && raster.channels != 4) ||
+            buffer.Length() != pixels * raster.channels)
+        {
+            Napi::TypeError::New(env, "Page data must be gray, RGB or RGBA with width * height * channels bytes").ThrowAsJavaScriptException();
+            return false;
+        }
+
+        raster.pixels = buffer.Data();
+        pages.push_back(raster);
+        buffers.push_back(Napi::Persistent(buffer));
+    }
+
+    if (options.Has("format") && options.Get("format").IsString())
+    {
+        std::string format = options.Get("format").As<Napi::String>().Utf8Value();
+        if (format != "pwg" && format != "urf")
+        {
+            Napi::TypeError::New(env, "format must be 'pwg' or 'urf'").ThrowAsJavaScriptException();
+            return false;
+        }
+        rasterOptions.format = format == "urf" ? RasterFormat::Urf : RasterFormat::Pwg;
+    }
+
+    if (options.Has("resolution") && options.Get("resolution").IsNumber())
+    {
+        rasterOptions.resolution = options.Get("resolution").As<Napi::Number>().Uint32Value();
+    }
+
+    if (options.Has("grayscale") && options.Get("grayscale").IsBoolean())
+    {
+        rasterOptions.grayscale = options.Get("grayscale").As<Napi::Boolean>().Value();
+    }
+
+    if (options.Has("threads") && options.Get("threads").IsNumber())
+    {
+        rasterOptions.threads = options.Get("threads").As<Napi::Number>().Uint32Value();
+    }
+
+    return true;
+}
+
+Napi::Value PrintRaster(const Napi::CallbackInfo &info)
+{
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsObject())
+    {
+        Napi::TypeError::New(env, "Expected an object as argument").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    Napi::Object options = info[0].As<Napi::Object>();
+
+    if (!options.Has("printerName") || !options.Get("printerName").IsString())
+    {
+        Napi::TypeError::New(env, "printerName must be a string").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    std::string printerName = options.Get("printerName").As<Napi::String>().Utf8Value();
+    std::vector<RasterPage> pages;
+    std::vector<BufferReference> buffers;
+    RasterOptions rasterOptions;
+    DocumentCompression compression;
+    if (!ParseRasterOptions(env, options, pages, buffers, rasterOptions) ||
+        !ParseCompression(env, options, compression))
+    {
+        return env.Null();
+    }
+
+    return QueuePromise(
+        env,
+        "printRaster",
+        printerName,
+        [printerName, pages = std::move(pages), buffers = std::move(buffers), rasterOptions, compression](SharedResources *shared)
         {
-            auto printer = worker->GetPrinter()->GetStatusPrinter(printerName);
-            worker->SetPrinterResult(printer);
+            RasterEncoder encoder(rasterOptions);
+            bool success = RequirePrinter(shared)->PrintStream(
+                               printerName, RasterEncoder::MimeType(rasterOptions.format),
+                               [&encoder, &pages](const ChunkWriter &write)
+                               { return encoder.Encode(pages, write); },
+                               compression) == PrintOutcome::Printed;
+            return PrintResult{printerName, success};
         });
+}
 
-    worker->Queue();
-    return deferred.Promise();
+Napi::Value EncodeRaster(const Napi::CallbackInfo &info)
+{
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsObject())
+    {
+        Napi::TypeError::New(env, "Expected an object as argument").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    std::vector<RasterPage> pages;
+    std::vector<BufferReference> buffers;
+    RasterOptions rasterOptions;
+    if (!ParseRasterOptions(env, info[0].As<Napi::Object>(), pages, buffers, rasterOptions))
+    {
+        return env.Null();
+    }
+
+    return QueuePromise(
+        env,
+        "encodeRaster",
+        std::string(),
+        [pages = std::move(pages), buffers = std::move(buffers), rasterOptions](SharedResources *)
+        {
+            RasterResult result;
+            RasterEncoder encoder(rasterOptions);
+            encoder.Encode(pages, [&result](const uint8_t *chunk, size_t size)
+                           {
+                result.data.insert(result.data.end(), chunk, chunk + size);
+                return true; });
+            return result;
+        });
+}
+
+Napi::Value GetRawStatus(const Napi::CallbackInfo &info)
+{
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsObject())
+    {
+        Napi::TypeError::New(env, "Expected an object as argument").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    Napi::Object options = info[0].As<Napi::Object>();
+
+    if (!options.Has("target") || !options.Get("target").IsString())
+    {
+        Napi::TypeError::New(env, "target must be a string").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    std::string target = options.Get("target").As<Napi::String>().Utf8Value();
+
+    bool useAsb = false;
+    if (options.Has("asb") && options.Get("asb").IsBoolean())
+    {
+        useAsb = options.Get("asb").As<Napi::Boolean>().Value();
+    }
+
+    int timeoutMs = 500;
+    if (options.Has("timeoutMs") && options.Get("timeoutMs").IsNumber())
+    {
+        timeoutMs = options.Get("timeoutMs").As<Napi::Number>().Int32Value();
+    }
+
+    return QueuePromise(
+        env,
+        "getRawStatus",
+        target,
+        [target, useAsb, timeoutMs](SharedResources *shared)
+        {
+            if (!shared)
+                throw std::runtime_error("Addon is shutting down");
+            return RawStatusResult{target, shared->GetEscPosStatus().Get(target)->Query(useAsb, timeoutMs)};
+        });
+}
+
+Napi::Value CloseRawStatus(const Napi::CallbackInfo &info)
+{
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsObject() ||
+        !info[0].As<Napi::Object>().Get("target").IsString())
+    {
+        Napi::TypeError::New(env, "Expected an object with a 'target' string").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    std::string target = info[0].As<Napi::Object>().Get("target").As<Napi::String>().Utf8Value();
+    std::shared_ptr<SharedResources> shared = AddonContext::Get(env)->GetShared();
+    return Napi::Boolean::New(env, shared && shared->GetEscPosStatus().Close(target));
+}
+
+Napi::Value SetTracing(const Napi::CallbackInfo &info)
+{
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsObject() ||
+        !info[0].As<Napi::Object>().Get("enabled").IsBoolean())
+    {
+        Napi::TypeError::New(env, "Expected an object with an 'enabled' boolean").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    Trace::SetEnabled(info[0].As<Napi::Object>().Get("enabled").As<Napi::Boolean>().Value());
+    return env.Undefined();
+}
+
+Napi::Value DumpTrace(const Napi::CallbackInfo &info)
+{
+    return Napi::String::New(info.Env(), Trace::Dump());
+}
+
+Napi::Value IsPrintingAvailable(const Napi::CallbackInfo &info)
+{
+    std::shared_ptr<SharedResources> shared = AddonContext::Get(info.Env())->GetShared();
+    return Napi::Boolean::New(info.Env(), shared && shared->GetPrinter() && shared->GetPrinter()->IsAvailable());
+}
+
+Napi::Value GetNativeStats(const Napi::CallbackInfo &info)
+{
+    Napi::Env env = info.Env();
+
+    size_t queuedJobs = 0;
+    size_t queuedBytes = 0;
+    std::shared_ptr<SharedResources> shared = AddonContext::Get(env)->GetShared();
+    std::vector<std::shared_ptr<PrintQueue>> queues;
+    if (shared)
+    {
+        queues = shared->GetQueues();
+    }
+    for (const auto &queue : queues)
+    {
+        PrintQueueStats stats = queue->GetStats();
+        queuedJobs += stats.depth;
+        queuedBytes += stats.bytes;
+    }
+
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("liveWorkers", static_cast<double>(liveWorkers.load()));
+    result.Set("queues", static_cast<double>(queues.size()));
+    result.Set("queuedJobs", static_cast<double>(queuedJobs));
+    result.Set("queuedBytes", static_cast<double>(queuedBytes));
+    return result;
+}
+
+Napi::Value DecodeStateReasons(const Napi::CallbackInfo &info)
+{
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsNumber())
+    {
+        Napi::TypeError::New(env, "stateReasons must be a number").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    return CreateReasonList(env, info[0].As<Napi::Number>().Uint32Value());
+}
+
+Napi::Object CreateStateReasonFlags(Napi::Env env)
+{
+    // Constantes no formato MEDIA_EMPTY, geradas da mesma tabela do decodificador.
+    Napi::Object flags = Napi::Object::New(env);
+    for (unsigned bit = 0; bit < 32; bit++)
+    {
+        std::string name = PrinterStateDecoder::ReasonName(bit);
+        for (auto &c : name)
+            c = c == '-' ? '_' : static_cast<char>(toupper(static_cast<unsigned char>(c)));
+        flags.Set(name, static_cast<double>(1u << bit));
+    }
+    return flags;
 }
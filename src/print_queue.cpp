@@ -0,0 +1,381 @@
+#include "print_queue.h"
+#include "trace.h"
+#include <exception>
+
+namespace
+{
+    void Resolve(PrintJob &job, const std::string &printerName, bool success)
+    {
+        JobResult result;
+        result.id = job.id;
+        result.traceId = job.traceId;
+        result.printerName = printerName;
+        result.success = success;
+        job.sink->Settle(std::move(result));
+    }
+
+    void Reject(PrintJob &job, const std::string &printerName, const std::string &error, const char *code)
+    {
+        JobResult result;
+        result.id = job.id;
+        result.traceId = job.traceId;
+        result.printerName = printerName;
+        result.error = error;
+        result.code = code ? code : "";
+        job.sink->Settle(std::move(result));
+    }
+}
+
+PrintQueue::PrintQueue(const std::string &printerName, PrinterInterface *printer)
+    : printerName(printerName),
+      printer(printer),
+      queuedJobs(0),
+      queuedBytes(0),
+      timedJobs(0),
+      rejected(0),
+      printing(false),
+      running(false),
+      stopping(false),
+      windowMs(0),
+      coalesceBytes(0),
+      maxJobs(kDefaultMaxJobs),
+      maxBytes(kDefaultMaxBytes),
+      agingMs(kDefaultAgingMs)
+{
+}
+
+PrintQueue::~PrintQueue()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    changed.notify_all();
+    if (thread.joinable())
+        thread.join();
+}
+
+void PrintQueue::SetCoalescing(uint32_t windowMs, size_t maxBytes)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    this->windowMs = windowMs;
+    this->coalesceBytes = maxBytes;
+    changed.notify_all();
+}
+
+void PrintQueue::SetLimits(size_t maxJobs, size_t maxBytes, uint32_t agingMs)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    this->maxJobs = maxJobs;
+    this->maxBytes = maxBytes;
+    this->agingMs = agingMs;
+}
+
+bool PrintQueue::HasRoomLocked(size_t bytes) const
+{
+    // Fila vazia aceita sempre, para que um trabalho maior que o limite não fique barrado.
+    if (queuedJobs == 0)
+        return true;
+    if (maxJobs > 0 && queuedJobs >= maxJobs)
+        return false;
+    return maxBytes == 0 || queuedBytes + bytes <= maxBytes;
+}
+
+bool PrintQueue::HasRoom(size_t bytes)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (HasRoomLocked(bytes))
+        return true;
+    rejected++;
+    return false;
+}
+
+bool PrintQueue::Push(PrintJob &&job)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if (!HasRoomLocked(job.Size()))
+    {
+        rejected++;
+        return false;
+    }
+
+    job.enqueuedAt = std::chrono::steady_clock::now();
+    queuedJobs++;
+    queuedBytes += job.Size();
+    if (job.deadline != std::chrono::steady_clock::time_point::max())
+        timedJobs++;
+    jobs[job.priority].push_back(std::move(job));
+    changed.notify_all();
+
+    if (!running)
+    {
+        // A thread anterior saiu por ociosidade; já soltou o lock, então o join é imediato.
+        if (thread.joinable())
+            thread.join();
+        thread = std::thread(&PrintQueue::Run, this);
+        running = true;
+    }
+    return true;
+}
+
+void PrintQueue::Drop(const JobSink *sink)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto &queue : jobs)
+    {
+        for (auto it = queue.begin(); it != queue.end();)
+        {
+            if (it->sink.get() != sink)
+            {
+                ++it;
+                continue;
+            }
+
+            queuedBytes -= it->Size();
+            queuedJobs--;
+            if (it->deadline != std::chrono::steady_clock::time_point::max())
+                timedJobs--;
+            it = queue.erase(it);
+        }
+    }
+}
+
+int PrintQueue::NextClassLocked(std::chrono::steady_clock::time_point now) const
+{
+    // Cada agingMs de espera promove o trabalho uma classe, assim os trabalhos
+    // em lote avançam mesmo sob um fluxo contínuo de prioridade alta.
+    int best = -1;
+    long long bestRank = 0;
+
+    for (int c = 0; c < PRIORITY_COUNT; c++)
+    {
+        if (jobs[c].empty())
+            continue;
+
+        const PrintJob &front = jobs[c].front();
+        long long rank = c;
+        if (agingMs > 0)
+        {
+            auto waited = std::chrono::duration_cast<std::chrono::milliseconds>(now - front.enqueuedAt).count();
+            rank -= waited / agingMs;
+            if (rank < 0)
+                rank = 0;
+        }
+
+        if (best < 0 || rank < bestRank ||
+            (rank == bestRank && front.enqueuedAt < jobs[best].front().enqueuedAt))
+        {
+            best = c;
+            bestRank = rank;
+        }
+    }
+    return best;
+}
+
+void PrintQueue::TakeExpiredLocked(std::chrono::steady_clock::time_point now, std::vector<PrintJob> &expired)
+{
+    if (timedJobs == 0)
+        return;
+
+    for (auto &queue : jobs)
+    {
+        for (auto it = queue.begin(); it != queue.end();)
+        {
+            if (it->deadline > now)
+            {
+                ++it;
+                continue;
+            }
+
+            queuedBytes -= it->Size();
+            queuedJobs--;
+            timedJobs--;
+            expired.push_back(std::move(*it));
+            it = queue.erase(it);
+        }
+    }
+}
+
+std::vector<PrintJob> PrintQueue::TakeBatchLocked(std::unique_lock<std::mutex> &lock, std::vector<PrintJob> &expired)
+{
+    std::vector<PrintJob> batch;
+
+    if (windowMs > 0 && jobs[PRIORITY_HIGH].empty())
+    {
+        auto oldest = std::chrono::steady_clock::time_point::max();
+        for (const auto &queue : jobs)
+        {
+            if (!queue.empty() && queue.front().enqueuedAt < oldest)
+                oldest = queue.front().enqueuedAt;
+        }
+
+        // Trabalhos de prioridade alta não esperam a janela fechar.
+        changed.wait_until(lock, oldest + std::chrono::milliseconds(windowMs), [this]
+                           { return stopping || windowMs == 0 || !jobs[PRIORITY_HIGH].empty() ||
+                                    (coalesceBytes > 0 && queuedBytes >= coalesceBytes); });
+        if (stopping)
+            return batch;
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    TakeExpiredLocked(now, expired);
+
+    size_t batchBytes = 0;
+    for (;;)
+    {
+        int c = NextClassLocked(now);
+        if (c < 0)
+            break;
+
+        PrintJob &next = jobs[c].front();
+        if (!batch.empty() &&
+            (next.dataType != "RAW" || batch.front().dataType != "RAW" ||
+             next.compression != batch.front().compression ||
+             (coalesceBytes > 0 && batchBytes + next.Size() > coalesceBytes)))
+            break;
+
+        batchBytes += next.Size();
+        queuedBytes -= next.Size();
+        queuedJobs--;
+        if (next.deadline != std::chrono::steady_clock::time_point::max())
+            timedJobs--;
+        batch.push_back(std::move(next));
+        jobs[c].pop_front();
+
+        if (windowMs == 0)
+            break;
+    }
+
+    return batch;
+}
+
+void PrintQueue::Run()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;)
+    {
+        if (!changed.wait_for(lock, std::chrono::milliseconds(kIdleThreadMs), [this]
+                              { return stopping || queuedJobs > 0; }))
+        {
+            running = false;
+            return;
+        }
+        if (stopping)
+            return;
+
+        std::vector<PrintJob> expired;
+        std::vector<PrintJob> batch = TakeBatchLocked(lock, expired);
+        printing = !batch.empty();
+        lock.unlock();
+
+        for (auto &job : expired)
+            Reject(job, printerName, "Print job for '" + printerName + "' timed out before it was sent", "ETIMEDOUT");
+        if (!batch.empty())
+        {
+            // Sem o AsyncWorker para converter exceções em rejeições, a fila
+            // faz isso aqui. Trabalhos já liquidados ignoram o segundo resultado.
+            try
+            {
+                PrintBatch(batch);
+            }
+            catch (const std::exception &e)
+            {
+                for (auto &job : batch)
+                    Reject(job, printerName, e.what(), nullptr);
+            }
+        }
+
+        lock.lock();
+        printing = false;
+    }
+}
+
+void PrintQueue::PrintBatch(std::vector<PrintJob> &batch)
+{
+    if (!printer)
+    {
+        for (auto &job : batch)
+            Reject(job, printerName, "Failed to create printer", nullptr);
+        return;
+    }
+
+    if (Trace::IsEnabled())
+    {
+        auto now = Trace::Clock::now();
+        for (const auto &job : batch)
+        {
+            if (job.traceId)
+                Trace::Record("queue-wait", printerName, job.traceId, job.enqueuedAt, now);
+        }
+    }
+
+    // Num lote agrupado, as fases do spooler ficam com o id do primeiro trabalho.
+    TraceJobScope traceJob(batch.front().traceId, printerName);
+    const std::vector<PrintJob> &jobs = batch;
+    PrintOutcome merged = printer->PrintStream(printerName, batch.front().dataType, [&jobs](const ChunkWriter &write)
+                                               {
+        for (const auto &job : jobs)
+        {
+            if (!write(job.data->data(), job.data->size()))
+                return false;
+        }
+        return true; }, batch.front().compression);
+
+    if (merged == PrintOutcome::Printed || batch.size() == 1)
+    {
+        for (auto &job : batch)
+            Resolve(job, printerName, merged == PrintOutcome::Printed);
+        return;
+    }
+
+    // Parte do trabalho combinado pode ter saído na impressora: reenviar
+    // duplicaria esses tickets, então todos recebem o mesmo erro.
+    if (merged == PrintOutcome::Failed)
+    {
+        for (auto &job : batch)
+            Reject(job, printerName,
+                   "Coalesced print job for '" + printerName + "' failed after it reached the spooler; some tickets may have printed",
+                   "EBATCHFAILED");
+        return;
+    }
+
+    // O trabalho combinado foi cancelado antes de imprimir: reenvia cada
+    // ticket sozinho para que o erro seja atribuído apenas a quem de fato falhou.
+    for (auto &job : batch)
+    {
+        TraceJobScope retryJob(job.traceId, printerName);
+        Resolve(job, printerName, printer->PrintDirect(printerName, *job.data, job.dataType, job.compression));
+    }
+}
+
+bool PrintQueue::IsDisposable()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return queuedJobs == 0 && !printing &&
+           windowMs == 0 && coalesceBytes == 0 &&
+           maxJobs == kDefaultMaxJobs && maxBytes == kDefaultMaxBytes && agingMs == kDefaultAgingMs;
+}
+
+PrintQueueStats PrintQueue::GetStats()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    auto now = std::chrono::steady_clock::now();
+
+    PrintQueueStats stats;
+    stats.depth = queuedJobs;
+    stats.bytes = queuedBytes;
+    stats.oldestAgeMs = 0;
+    stats.printing = printing || queuedJobs > 0;
+    stats.rejected = rejected;
+
+    for (const auto &queue : jobs)
+    {
+        if (queue.empty())
+            continue;
+        double age = std::chrono::duration<double, std::milli>(now - queue.front().enqueuedAt).count();
+        if (age > stats.oldestAgeMs)
+            stats.oldestAgeMs = age;
+    }
+    return stats;
+}
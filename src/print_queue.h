@@ -0,0 +1,154 @@
+#ifndef PRINT_QUEUE_H
+#define PRINT_QUEUE_H
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include "printer_interface.h"
+
+enum JobPriority
+{
+    PRIORITY_HIGH = 0,
+    PRIORITY_NORMAL,
+    PRIORITY_BULK,
+    PRIORITY_COUNT
+};
+
+// Payload imutável, compartilhado entre as filas quando o mesmo documento vai
+// para várias impressoras.
+using PrintPayload = std::shared_ptr<const std::vector<uint8_t>>;
+
+// Resultado de um trabalho, entregue a quem o enfileirou. Com error vazio o
+// trabalho passou pelo spooler e success diz se foi aceito; caso contrário a
+// promise rejeita com error e code.
+struct JobResult
+{
+    uint64_t id = 0;
+    uint64_t traceId = 0;
+    std::string printerName;
+    bool success = false;
+    std::string error;
+    std::string code;
+};
+
+// Dono das promises dos trabalhos. A fila chama Settle na sua própria thread;
+// a implementação leva o resultado até a thread do ambiente JS.
+class JobSink
+{
+public:
+    virtual ~JobSink() = default;
+    virtual void Settle(JobResult &&result) = 0;
+};
+
+struct PrintJob
+{
+    PrintJob(std::shared_ptr<JobSink> sink, uint64_t id)
+        : compression(DocumentCompression::None),
+          priority(PRIORITY_NORMAL),
+          deadline(std::chrono::steady_clock::time_point::max()),
+          traceId(0),
+          sink(std::move(sink)),
+          id(id) {}
+
+    size_t Size() const { return data ? data->size() : 0; }
+
+    PrintPayload data;
+    std::string dataType;
+    DocumentCompression compression;
+    JobPriority priority;
+    std::chrono::steady_clock::time_point enqueuedAt;
+    // Trabalhos que ainda estão na fila depois do prazo não são mais enviados.
+    std::chrono::steady_clock::time_point deadline;
+    uint64_t traceId;
+    std::shared_ptr<JobSink> sink;
+    uint64_t id;
+};
+
+struct PrintQueueStats
+{
+    size_t depth;
+    size_t bytes;
+    double oldestAgeMs;
+    bool printing;
+    uint64_t rejected;
+};
+
+// Fila nativa de uma impressora, com classes de prioridade e limites de
+// memória. Uma thread própria, criada no primeiro trabalho, drena a fila um
+// lote por vez; assim a janela de agrupamento e o spooler lento não ocupam
+// as threads do pool do libuv. Depois de kIdleThreadMs sem trabalho a thread
+// termina, e o próximo Push cria outra.
+//
+// Com agrupamento ativo, os trabalhos RAW que chegam dentro da janela (ou até
+// o limite de bytes) viram um único trabalho no spooler; cada chamador
+// continua recebendo a sua própria promise.
+class PrintQueue
+{
+public:
+    static constexpr size_t kDefaultMaxJobs = 1000;
+    static constexpr size_t kDefaultMaxBytes = 64 * 1024 * 1024;
+    static constexpr uint32_t kDefaultAgingMs = 2000;
+    static constexpr uint32_t kIdleThreadMs = 30000;
+
+    // printer precisa viver mais que a fila.
+    PrintQueue(const std::string &printerName, PrinterInterface *printer);
+    // Espera o lote em andamento terminar; os trabalhos ainda na fila são descartados.
+    ~PrintQueue();
+
+    const std::string &GetPrinterName() const { return printerName; }
+
+    void SetCoalescing(uint32_t windowMs, size_t maxBytes);
+    // 0 desativa o limite correspondente.
+    void SetLimits(size_t maxJobs, size_t maxBytes, uint32_t agingMs);
+
+    // Permite recusar um trabalho antes de copiar o payload.
+    bool HasRoom(size_t bytes);
+    // Retorna false se a fila estiver cheia.
+    bool Push(PrintJob &&job);
+    // Tira da fila os trabalhos ainda não enviados de sink, sem liquidá-los.
+    // Usado quando o ambiente que os enfileirou está saindo.
+    void Drop(const JobSink *sink);
+
+    PrintQueueStats GetStats();
+    // Vazia, sem lote em andamento e com a configuração padrão: pode ser
+    // descartada e recriada sob demanda sem que ninguém perceba.
+    bool IsDisposable();
+
+private:
+    void Run();
+    // Espera a janela de agrupamento e retira o próximo lote. Os trabalhos que
+    // venceram o prazo enquanto esperavam vão para expired.
+    std::vector<PrintJob> TakeBatchLocked(std::unique_lock<std::mutex> &lock, std::vector<PrintJob> &expired);
+    void PrintBatch(std::vector<PrintJob> &batch);
+
+    bool HasRoomLocked(size_t bytes) const;
+    int NextClassLocked(std::chrono::steady_clock::time_point now) const;
+    void TakeExpiredLocked(std::chrono::steady_clock::time_point now, std::vector<PrintJob> &expired);
+
+    std::string printerName;
+    PrinterInterface *printer;
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::deque<PrintJob> jobs[PRIORITY_COUNT];
+    size_t queuedJobs;
+    size_t queuedBytes;
+    size_t timedJobs;
+    uint64_t rejected;
+    bool printing;
+    bool running;
+    bool stopping;
+    uint32_t windowMs;
+    size_t coalesceBytes;
+    size_t maxJobs;
+    size_t maxBytes;
+    uint32_t agingMs;
+    std::thread thread;
+};
+
+#endif
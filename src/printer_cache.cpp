@@ -0,0 +1,249 @@
+#include "printer_cache.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace
+{
+    const uint8_t kMagic[4] = {'P', 'E', 'N', 'C'};
+    const uint32_t kVersion = 2;
+
+    class Writer
+    {
+    public:
+        std::vector<uint8_t> bytes;
+
+        void U8(uint8_t value) { bytes.push_back(value); }
+
+        void U32(uint32_t value)
+        {
+            for (int i = 0; i < 4; i++)
+                bytes.push_back(static_cast<uint8_t>(value >> (8 * i)));
+        }
+
+        void Str(const std::string &value)
+        {
+            U32(static_cast<uint32_t>(value.size()));
+            bytes.insert(bytes.end(), value.begin(), value.end());
+        }
+    };
+
+    class Reader
+    {
+    public:
+        Reader(const std::vector<uint8_t> &bytes) : bytes(bytes), pos(0) {}
+
+        bool U8(uint8_t &value)
+        {
+            if (pos + 1 > bytes.size())
+                return false;
+            value = bytes[pos++];
+            return true;
+        }
+
+        bool U32(uint32_t &value)
+        {
+            if (pos + 4 > bytes.size())
+                return false;
+            value = 0;
+            for (int i = 0; i < 4; i++)
+                value |= static_cast<uint32_t>(bytes[pos++]) << (8 * i);
+            return true;
+        }
+
+        bool Str(std::string &value)
+        {
+            uint32_t size;
+            if (!U32(size) || size > bytes.size() - pos)
+                return false;
+            value.assign(reinterpret_cast<const char *>(bytes.data()) + pos, size);
+            pos += size;
+            return true;
+        }
+
+        bool AtEnd() const { return pos == bytes.size(); }
+
+    private:
+        const std::vector<uint8_t> &bytes;
+        size_t pos;
+    };
+
+    std::atomic<uint32_t> tmpCounter(0);
+
+#ifdef _WIN32
+    std::wstring WidePath(const std::string &path)
+    {
+        std::wstring wpath(MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, NULL, 0), L'\0');
+        MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, &wpath[0], static_cast<int>(wpath.size()));
+        return wpath;
+    }
+#endif
+
+    FILE *OpenCacheFile(const std::string &path, const char *mode)
+    {
+#ifdef _WIN32
+        std::wstring wmode(mode, mode + strlen(mode));
+        return _wfopen(WidePath(path).c_str(), wmode.c_str());
+#else
+        return fopen(path.c_str(), mode);
+#endif
+    }
+
+    bool ReplaceCacheFile(const std::string &from, const std::string &to)
+    {
+#ifdef _WIN32
+        return MoveFileExW(WidePath(from).c_str(), WidePath(to).c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+        return rename(from.c_str(), to.c_str()) == 0;
+#endif
+    }
+
+    void RemoveCacheFile(const std::string &path)
+    {
+#ifdef _WIN32
+        _wremove(WidePath(path).c_str());
+#else
+        remove(path.c_str());
+#endif
+    }
+
+    // Nome único por processo e por chamada: duas gravações simultâneas do
+    // mesmo cache (revalidação em segundo plano, outro worker, outra janela do
+    // Electron) nunca escrevem no mesmo temporário.
+    std::string TempPath(const std::string &path)
+    {
+#ifdef _WIN32
+        unsigned long pid = GetCurrentProcessId();
+#else
+        long pid = static_cast<long>(getpid());
+#endif
+        return path + "." + std::to_string(pid) + "." + std::to_string(++tmpCounter) + ".tmp";
+    }
+
+    bool ReadCacheFile(const std::string &path, std::vector<uint8_t> &bytes)
+    {
+        FILE *file = OpenCacheFile(path, "rb");
+        if (file == NULL)
+            return false;
+
+        uint8_t chunk[4096];
+        size_t read;
+        while ((read = fread(chunk, 1, sizeof(chunk), file)) > 0)
+        {
+            bytes.insert(bytes.end(), chunk, chunk + read);
+        }
+
+        bool ok = ferror(file) == 0;
+        fclose(file);
+        return ok;
+    }
+}
+
+std::vector<uint8_t> PrinterCache::Serialize(const std::vector<PrinterInfo> &printers)
+{
+    Writer writer;
+    writer.bytes.insert(writer.bytes.end(), kMagic, kMagic + sizeof(kMagic));
+    writer.U32(kVersion);
+    writer.U32(static_cast<uint32_t>(printers.size()));
+
+    for (const auto &printer : printers)
+    {
+        writer.Str(printer.name);
+        writer.U8(printer.isDefault ? 1 : 0);
+        writer.Str(printer.status);
+        writer.U32(printer.stateReasons);
+        writer.U8(static_cast<uint8_t>(printer.stateSeverity));
+        writer.U32(static_cast<uint32_t>(printer.details.size()));
+        for (const auto &detail : printer.details)
+        {
+            writer.Str(detail.first);
+            writer.Str(detail.second);
+        }
+    }
+
+    return writer.bytes;
+}
+
+bool PrinterCache::Deserialize(const std::vector<uint8_t> &bytes, std::vector<PrinterInfo> &printers)
+{
+    if (bytes.size() < sizeof(kMagic) || !std::equal(kMagic, kMagic + sizeof(kMagic), bytes.begin()))
+        return false;
+
+    Reader reader(bytes);
+    uint8_t skip;
+    for (size_t i = 0; i < sizeof(kMagic); i++)
+        reader.U8(skip);
+
+    uint32_t version, count;
+    if (!reader.U32(version) || version != kVersion || !reader.U32(count))
+        return false;
+
+    std::vector<PrinterInfo> result;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        PrinterInfo printer;
+        uint8_t isDefault, severity;
+        uint32_t detailCount;
+
+        if (!reader.Str(printer.name) || !reader.U8(isDefault) ||
+            !reader.Str(printer.status) || !reader.U32(printer.stateReasons) ||
+            !reader.U8(severity) || severity > SEVERITY_ERROR || !reader.U32(detailCount))
+            return false;
+
+        printer.isDefault = isDefault != 0;
+        printer.stateSeverity = static_cast<PrinterStateSeverity>(severity);
+        for (uint32_t j = 0; j < detailCount; j++)
+        {
+            std::string key, value;
+            if (!reader.Str(key) || !reader.Str(value))
+                return false;
+            printer.details[key] = value;
+        }
+        result.push_back(std::move(printer));
+    }
+
+    if (!reader.AtEnd())
+        return false;
+
+    printers = std::move(result);
+    return true;
+}
+
+bool PrinterCache::Load(const std::string &path, std::vector<PrinterInfo> &printers)
+{
+    std::vector<uint8_t> bytes;
+    return ReadCacheFile(path, bytes) && Deserialize(bytes, printers);
+}
+
+bool PrinterCache::Store(const std::string &path, const std::vector<PrinterInfo> &printers)
+{
+    std::vector<uint8_t> bytes = Serialize(printers);
+
+    std::vector<uint8_t> current;
+    if (ReadCacheFile(path, current) && current == bytes)
+        return false;
+
+    // Escreve em um arquivo temporário e troca, para nunca deixar um cache truncado.
+    std::string tmpPath = TempPath(path);
+    FILE *file = OpenCacheFile(tmpPath, "wb");
+    if (file == NULL)
+        return false;
+
+    bool ok = fwrite(bytes.data(), 1, bytes.size(), file) == bytes.size();
+    ok = (fclose(file) == 0) && ok;
+
+    if (!ok || !ReplaceCacheFile(tmpPath, path))
+    {
+        RemoveCacheFile(tmpPath);
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,22 @@
+#ifndef PRINTER_CACHE_H
+#define PRINTER_CACHE_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "printer_interface.h"
+
+// Cache binário da última enumeração de impressoras, usado para servir
+// getPrinters() imediatamente na inicialização enquanto a lista é revalidada.
+class PrinterCache
+{
+public:
+    static bool Load(const std::string &path, std::vector<PrinterInfo> &printers);
+    // Grava apenas se o conteúdo mudou; retorna true quando o arquivo foi reescrito.
+    static bool Store(const std::string &path, const std::vector<PrinterInfo> &printers);
+
+    static std::vector<uint8_t> Serialize(const std::vector<PrinterInfo> &printers);
+    static bool Deserialize(const std::vector<uint8_t> &bytes, std::vector<PrinterInfo> &printers);
+};
+
+#endif
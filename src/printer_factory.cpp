@@ -1,5 +1,11 @@
 #include "printer_factory.h"
 
+#ifdef PRINTER_ELECTRON_NODE_MOCK
+#include "mock_printer.h"
+#include <cstdlib>
+#include <cstring>
+#endif
+
 #ifdef _WIN32
 #include "windows_printer.h"
 #elif defined(__APPLE__)
@@ -10,6 +16,14 @@
 
 std::unique_ptr<PrinterInterface> PrinterFactory::Create()
 {
+#ifdef PRINTER_ELECTRON_NODE_MOCK
+    // Só nos binários de benchmark (node-gyp rebuild --mock-backend); os de
+    // produção não têm como trocar o backend pelo ambiente.
+    const char *backend = getenv("PRINTER_ELECTRON_NODE_BACKEND");
+    if (backend && strcmp(backend, "mock") == 0)
+        return std::make_unique<MockPrinter>();
+#endif
+
 #ifdef _WIN32
     return std::make_unique<WindowsPrinter>();
 #elif defined(__APPLE__)
@@ -17,4 +31,4 @@ std::unique_ptr<PrinterInterface> PrinterFactory::Create()
 #else
     return std::make_unique<LinuxPrinter>();
 #endif
-}
\ No newline at end of file
+}
@@ -5,6 +5,8 @@
 #include <vector>
 #include <map>
 #include <cstdint>
+#include <functional>
+#include "printer_state.h"
 
 struct PrinterInfo
 {
@@ -12,18 +14,49 @@ struct PrinterInfo
     bool isDefault;
     std::map<std::string, std::string> details;
     std::string status;
+    // Bitmask de PrinterStateReason e a maior severidade entre as condições.
+    uint32_t stateReasons = 0;
+    PrinterStateSeverity stateSeverity = SEVERITY_NONE;
 };
 
+// Compressão do documento no caminho até o servidor de impressão. Só o CUPS
+// aplica; os outros backends enviam sem compressão.
+enum class DocumentCompression
+{
+    None,
+    Gzip
+};
+
+// Resultado de PrintStream. NotSent garante que nada chegou à impressora: o
+// trabalho foi recusado, ou cancelado antes de o spooler aceitar o documento.
+// Com Failed, parte do documento pode ter sido impressa.
+enum class PrintOutcome
+{
+    Printed,
+    NotSent,
+    Failed
+};
+
+// Recebe um bloco do documento; retorna false para abortar o envio.
+using ChunkWriter = std::function<bool(const uint8_t *data, size_t size)>;
+// Gera o documento chamando o writer quantas vezes precisar.
+using DocumentProducer = std::function<bool(const ChunkWriter &write)>;
+
 class PrinterInterface
 {
 public:
     virtual ~PrinterInterface() = default;
 
+    // Carrega o backend do sistema sob demanda; false se ele não existir na máquina.
+    virtual bool IsAvailable() = 0;
     virtual PrinterInfo GetPrinterDetails(const std::string &printerName, bool isDefault = false) = 0;
     virtual std::vector<PrinterInfo> GetPrinters() = 0;
     virtual PrinterInfo GetSystemDefaultPrinter() = 0;
-    virtual bool PrintDirect(const std::string &printerName, const std::vector<uint8_t> &data, const std::string &dataType) = 0;
+    virtual bool PrintDirect(const std::string &printerName, const std::vector<uint8_t> &data, const std::string &dataType,
+                             DocumentCompression compression = DocumentCompression::None) = 0;
     virtual PrinterInfo GetStatusPrinter(const std::string &printerName) = 0;
+    virtual PrintOutcome PrintStream(const std::string &printerName, const std::string &dataType, const DocumentProducer &produce,
+                                     DocumentCompression compression = DocumentCompression::None) = 0;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,149 @@
+#include "printer_state.h"
+#include <cstring>
+
+namespace
+{
+    // Nome canônico de cada bit, usado na lista decodificada enviada ao JS.
+    const char *const kReasonNames[32] = {
+        "other",
+        "offline",
+        "paused",
+        "moving-to-paused",
+        "shutdown",
+        "connecting-to-device",
+        "timed-out",
+        "stopping",
+        "stopped-partly",
+        "media-needed",
+        "media-jam",
+        "media-low",
+        "media-empty",
+        "input-tray-missing",
+        "output-tray-missing",
+        "output-area-almost-full",
+        "output-area-full",
+        "toner-low",
+        "toner-empty",
+        "marker-supply-low",
+        "marker-supply-empty",
+        "marker-waste-almost-full",
+        "marker-waste-full",
+        "cover-open",
+        "door-open",
+        "spool-area-full",
+        "resource-unavailable",
+        "fuser-error",
+        "warming-up",
+        "user-intervention",
+        "missing-filter",
+        "error",
+    };
+
+    bool EndsWith(const char *value, size_t length, const char *suffix, size_t suffixLength)
+    {
+        return length > suffixLength && memcmp(value + length - suffixLength, suffix, suffixLength) == 0;
+    }
+
+    bool StartsWith(const char *value, size_t length, const char *prefix, size_t prefixLength)
+    {
+        return length > prefixLength && memcmp(value, prefix, prefixLength) == 0;
+    }
+
+    // Palavras-chave de extensão do CUPS ou de fabricantes (cups-*, com.*, org.*).
+    bool IsVendorKeyword(const char *keyword, size_t length)
+    {
+        return StartsWith(keyword, length, "cups-", 5) ||
+               StartsWith(keyword, length, "com.", 4) ||
+               StartsWith(keyword, length, "org.", 4);
+    }
+}
+
+void PrinterStateDecoder::Add(uint32_t reason, PrinterStateSeverity severity, PrinterState &state)
+{
+    state.reasons |= reason;
+    if (severity > state.severity)
+        state.severity = severity;
+}
+
+void PrinterStateDecoder::AddKeyword(const char *keyword, PrinterState &state)
+{
+    using namespace printer_state;
+
+    size_t length = strlen(keyword);
+    if (length == 0 || (length == 4 && memcmp(keyword, "none", 4) == 0))
+        return;
+
+    // Sem sufixo, a RFC 8011 manda tratar a condição como erro.
+    PrinterStateSeverity severity = SEVERITY_ERROR;
+    bool hasSuffix = true;
+    if (EndsWith(keyword, length, "-report", 7))
+    {
+        severity = SEVERITY_REPORT;
+        length -= 7;
+    }
+    else if (EndsWith(keyword, length, "-warning", 8))
+    {
+        severity = SEVERITY_WARNING;
+        length -= 8;
+    }
+    else if (EndsWith(keyword, length, "-error", 6))
+    {
+        severity = SEVERITY_ERROR;
+        length -= 6;
+    }
+    else
+    {
+        hasSuffix = false;
+    }
+
+    uint8_t index = kSlotTable[Hash(keyword, length, kSeed) % kSlots];
+    if (index != kEmpty &&
+        Length(kKeywords[index].name) == length &&
+        memcmp(kKeywords[index].name, keyword, length) == 0)
+    {
+        // Sem sufixo, as condições de pausa usam a severidade comum aos backends.
+        if (!hasSuffix && IsPauseReason(kKeywords[index].reason))
+            severity = kPausedSeverity;
+        Add(kKeywords[index].reason, severity, state);
+    }
+    else
+    {
+        // O CUPS manda palavras-chave informativas sem sufixo durante a
+        // operação normal (ex.: cups-waiting-for-job-completed); uma impressora
+        // saudável não pode aparecer com severidade de erro por causa delas.
+        if (!hasSuffix && IsVendorKeyword(keyword, length))
+            severity = SEVERITY_REPORT;
+        Add(REASON_OTHER, severity, state);
+    }
+}
+
+std::vector<std::string> PrinterStateDecoder::Describe(uint32_t reasons)
+{
+    std::vector<std::string> names;
+    for (int bit = 0; bit < 32; bit++)
+    {
+        if (reasons & (1u << bit))
+            names.push_back(kReasonNames[bit]);
+    }
+    return names;
+}
+
+const char *PrinterStateDecoder::ReasonName(unsigned bit)
+{
+    return bit < 32 ? kReasonNames[bit] : nullptr;
+}
+
+const char *PrinterStateDecoder::SeverityName(PrinterStateSeverity severity)
+{
+    switch (severity)
+    {
+    case SEVERITY_REPORT:
+        return "report";
+    case SEVERITY_WARNING:
+        return "warning";
+    case SEVERITY_ERROR:
+        return "error";
+    default:
+        return "none";
+    }
+}
@@ -0,0 +1,189 @@
+#ifndef PRINTER_STATE_H
+#define PRINTER_STATE_H
+
+#include <array>
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+// Condições da impressora em um bitmask de 32 bits, comum a todos os backends.
+// No CUPS vêm dos valores de printer-state-reasons; no Windows, dos
+// PRINTER_STATUS_*. Cabe em um número do JS e pode ser comparado com
+// operadores bit a bit sem alocar strings.
+enum PrinterStateReason : uint32_t
+{
+    REASON_OTHER = 1u << 0,
+    REASON_OFFLINE = 1u << 1,
+    REASON_PAUSED = 1u << 2,
+    REASON_MOVING_TO_PAUSED = 1u << 3,
+    REASON_SHUTDOWN = 1u << 4,
+    REASON_CONNECTING_TO_DEVICE = 1u << 5,
+    REASON_TIMED_OUT = 1u << 6,
+    REASON_STOPPING = 1u << 7,
+    REASON_STOPPED_PARTLY = 1u << 8,
+    REASON_MEDIA_NEEDED = 1u << 9,
+    REASON_MEDIA_JAM = 1u << 10,
+    REASON_MEDIA_LOW = 1u << 11,
+    REASON_MEDIA_EMPTY = 1u << 12,
+    REASON_INPUT_TRAY_MISSING = 1u << 13,
+    REASON_OUTPUT_TRAY_MISSING = 1u << 14,
+    REASON_OUTPUT_AREA_ALMOST_FULL = 1u << 15,
+    REASON_OUTPUT_AREA_FULL = 1u << 16,
+    REASON_TONER_LOW = 1u << 17,
+    REASON_TONER_EMPTY = 1u << 18,
+    REASON_MARKER_SUPPLY_LOW = 1u << 19,
+    REASON_MARKER_SUPPLY_EMPTY = 1u << 20,
+    REASON_MARKER_WASTE_ALMOST_FULL = 1u << 21,
+    REASON_MARKER_WASTE_FULL = 1u << 22,
+    REASON_COVER_OPEN = 1u << 23,
+    REASON_DOOR_OPEN = 1u << 24,
+    REASON_SPOOL_AREA_FULL = 1u << 25,
+    REASON_RESOURCE_UNAVAILABLE = 1u << 26,
+    REASON_FUSER_ERROR = 1u << 27,
+    REASON_WARMING_UP = 1u << 28,
+    REASON_USER_INTERVENTION = 1u << 29,
+    REASON_MISSING_FILTER = 1u << 30,
+    REASON_ERROR = 1u << 31
+};
+
+enum PrinterStateSeverity : uint8_t
+{
+    SEVERITY_NONE = 0,
+    SEVERITY_REPORT,
+    SEVERITY_WARNING,
+    SEVERITY_ERROR
+};
+
+namespace printer_state
+{
+    struct Keyword
+    {
+        const char *name;
+        uint32_t reason;
+    };
+
+    // Palavras-chave sem o sufixo de severidade (-report, -warning, -error).
+    // Várias podem cair no mesmo bit.
+    // Severidade das condições de pausa quando a origem não informa uma: o
+    // "paused" sem sufixo do CUPS e o PRINTER_STATUS_PAUSED do Windows. Pausar
+    // é uma ação do operador, não uma falha, e a mesma condição precisa ter a
+    // mesma severidade em todos os backends.
+    constexpr PrinterStateSeverity kPausedSeverity = SEVERITY_WARNING;
+
+    constexpr bool IsPauseReason(uint32_t reason)
+    {
+        return reason == REASON_PAUSED || reason == REASON_MOVING_TO_PAUSED || reason == REASON_SHUTDOWN;
+    }
+
+    constexpr Keyword kKeywords[] = {
+        {"other", REASON_OTHER},
+        {"offline", REASON_OFFLINE},
+        {"paused", REASON_PAUSED},
+        {"moving-to-paused", REASON_MOVING_TO_PAUSED},
+        {"shutdown", REASON_SHUTDOWN},
+        {"connecting-to-device", REASON_CONNECTING_TO_DEVICE},
+        {"timed-out", REASON_TIMED_OUT},
+        {"stopping", REASON_STOPPING},
+        {"stopped-partly", REASON_STOPPED_PARTLY},
+        {"media-needed", REASON_MEDIA_NEEDED},
+        {"media-jam", REASON_MEDIA_JAM},
+        {"media-low", REASON_MEDIA_LOW},
+        {"media-empty", REASON_MEDIA_EMPTY},
+        {"input-tray-missing", REASON_INPUT_TRAY_MISSING},
+        {"output-tray-missing", REASON_OUTPUT_TRAY_MISSING},
+        {"output-area-almost-full", REASON_OUTPUT_AREA_ALMOST_FULL},
+        {"output-area-full", REASON_OUTPUT_AREA_FULL},
+        {"toner-low", REASON_TONER_LOW},
+        {"toner-empty", REASON_TONER_EMPTY},
+        {"marker-supply-low", REASON_MARKER_SUPPLY_LOW},
+        {"marker-supply-empty", REASON_MARKER_SUPPLY_EMPTY},
+        {"marker-waste-almost-full", REASON_MARKER_WASTE_ALMOST_FULL},
+        {"marker-waste-full", REASON_MARKER_WASTE_FULL},
+        {"cover-open", REASON_COVER_OPEN},
+        {"door-open", REASON_DOOR_OPEN},
+        {"interlock-open", REASON_DOOR_OPEN},
+        {"spool-area-full", REASON_SPOOL_AREA_FULL},
+        {"interpreter-resource-unavailable", REASON_RESOURCE_UNAVAILABLE},
+        {"fuser-over-temp", REASON_FUSER_ERROR},
+        {"fuser-under-temp", REASON_FUSER_ERROR},
+        {"cups-missing-filter", REASON_MISSING_FILTER},
+        {"cups-insecure-filter", REASON_MISSING_FILTER},
+    };
+
+    constexpr size_t kKeywordCount = sizeof(kKeywords) / sizeof(kKeywords[0]);
+    constexpr size_t kSlots = 64;
+    constexpr uint8_t kEmpty = 0xff;
+
+    constexpr size_t Length(const char *s)
+    {
+        size_t n = 0;
+        while (s[n])
+            n++;
+        return n;
+    }
+
+    constexpr uint32_t Hash(const char *s, size_t length, uint32_t seed)
+    {
+        uint32_t h = 2166136261u ^ seed;
+        for (size_t i = 0; i < length; i++)
+        {
+            h ^= static_cast<uint8_t>(s[i]);
+            h *= 16777619u;
+        }
+        return h ^ (h >> 15);
+    }
+
+    constexpr bool IsPerfect(uint32_t seed)
+    {
+        bool used[kSlots] = {};
+        for (size_t i = 0; i < kKeywordCount; i++)
+        {
+            size_t slot = Hash(kKeywords[i].name, Length(kKeywords[i].name), seed) % kSlots;
+            if (used[slot])
+                return false;
+            used[slot] = true;
+        }
+        return true;
+    }
+
+    // Primeira semente sem colisões para a tabela, procurada fora da compilação:
+    // a busca em constexpr passa do limite de passos do MSVC (/constexpr:steps).
+    // Ao mudar kKeywords, se o static_assert falhar, procure a próxima semente
+    // com IsPerfect em um programa à parte e troque o valor aqui.
+    constexpr uint32_t kSeed = 1189;
+    static_assert(IsPerfect(kSeed), "kSeed is not a perfect hash seed for the printer-state-reasons table");
+
+    constexpr std::array<uint8_t, kSlots> BuildSlots()
+    {
+        std::array<uint8_t, kSlots> slots{};
+        for (auto &slot : slots)
+            slot = kEmpty;
+        for (size_t i = 0; i < kKeywordCount; i++)
+            slots[Hash(kKeywords[i].name, Length(kKeywords[i].name), kSeed) % kSlots] = static_cast<uint8_t>(i);
+        return slots;
+    }
+
+    constexpr std::array<uint8_t, kSlots> kSlotTable = BuildSlots();
+}
+
+struct PrinterState
+{
+    uint32_t reasons = 0;
+    PrinterStateSeverity severity = SEVERITY_NONE;
+};
+
+class PrinterStateDecoder
+{
+public:
+    // Soma um valor de printer-state-reasons (ex.: "media-empty-error") ao estado.
+    static void AddKeyword(const char *keyword, PrinterState &state);
+    static void Add(uint32_t reason, PrinterStateSeverity severity, PrinterState &state);
+
+    // Nomes das condições presentes no bitmask, na ordem dos bits.
+    static std::vector<std::string> Describe(uint32_t reasons);
+    static const char *ReasonName(unsigned bit);
+    static const char *SeverityName(PrinterStateSeverity severity);
+};
+
+#endif
@@ -0,0 +1,294 @@
+#include "raster_encoder.h"
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <thread>
+
+namespace
+{
+    const size_t kPwgHeaderSize = 1796;
+    const size_t kUrfPageHeaderSize = 32;
+    const uint32_t kMaxRun = 128;
+    const uint32_t kMaxLineRepeat = 256;
+
+    void PutBE32(std::vector<uint8_t> &out, size_t offset, uint32_t value)
+    {
+        out[offset] = static_cast<uint8_t>(value >> 24);
+        out[offset + 1] = static_cast<uint8_t>(value >> 16);
+        out[offset + 2] = static_cast<uint8_t>(value >> 8);
+        out[offset + 3] = static_cast<uint8_t>(value);
+    }
+
+    void PutString(std::vector<uint8_t> &out, size_t offset, const char *value)
+    {
+        memcpy(out.data() + offset, value, strlen(value));
+    }
+
+    uint8_t Composite(uint8_t color, uint8_t alpha)
+    {
+        return static_cast<uint8_t>((color * alpha + 255 * (255 - alpha) + 127) / 255);
+    }
+
+    // PackBits das especificações PWG/URF: n = 0..127 repete o próximo pixel
+    // n + 1 vezes; n = 129..255 copia os próximos 257 - n pixels literais.
+    void PackLine(const uint8_t *line, uint32_t width, uint32_t bpp, std::vector<uint8_t> &out)
+    {
+        auto same = [line, bpp](uint32_t a, uint32_t b)
+        {
+            return memcmp(line + a * bpp, line + b * bpp, bpp) == 0;
+        };
+
+        uint32_t x = 0;
+        while (x < width)
+        {
+            uint32_t run = 1;
+            while (x + run < width && run < kMaxRun && same(x, x + run))
+                run++;
+
+            if (run > 1)
+            {
+                out.push_back(static_cast<uint8_t>(run - 1));
+                out.insert(out.end(), line + x * bpp, line + (x + 1) * bpp);
+                x += run;
+                continue;
+            }
+
+            uint32_t start = x;
+            uint32_t count = 1;
+            x++;
+            while (x < width && count < kMaxRun && !(x + 1 < width && same(x, x + 1)))
+            {
+                count++;
+                x++;
+            }
+
+            out.push_back(count == 1 ? 0 : static_cast<uint8_t>(257 - count));
+            out.insert(out.end(), line + start * bpp, line + (start + count) * bpp);
+        }
+    }
+}
+
+RasterEncoder::RasterEncoder(const RasterOptions &options)
+    : options(options)
+{
+    if (this->options.bandHeight == 0)
+        this->options.bandHeight = 64;
+    if (this->options.resolution == 0)
+        this->options.resolution = 300;
+}
+
+const char *RasterEncoder::MimeType(RasterFormat format)
+{
+    return format == RasterFormat::Urf ? "image/urf" : "image/pwg-raster";
+}
+
+uint32_t RasterEncoder::OutputBytesPerPixel(const RasterPage &page) const
+{
+    return (page.channels == 1 || options.grayscale) ? 1 : 3;
+}
+
+void RasterEncoder::ConvertRow(const RasterPage &page, uint32_t row, uint8_t *out) const
+{
+    const uint8_t *in = page.pixels + static_cast<size_t>(row) * page.width * page.channels;
+    uint32_t bpp = OutputBytesPerPixel(page);
+
+    if (page.channels == 1)
+    {
+        memcpy(out, in, page.width);
+        return;
+    }
+
+    for (uint32_t x = 0; x < page.width; x++, in += page.channels)
+    {
+        uint8_t alpha = page.channels == 4 ? in[3] : 255;
+        uint8_t r = Composite(in[0], alpha);
+        uint8_t g = Composite(in[1], alpha);
+        uint8_t b = Composite(in[2], alpha);
+
+        if (bpp == 1)
+        {
+            out[x] = static_cast<uint8_t>((r * 77 + g * 150 + b * 29) >> 8);
+        }
+        else
+        {
+            out[x * 3] = r;
+            out[x * 3 + 1] = g;
+            out[x * 3 + 2] = b;
+        }
+    }
+}
+
+void RasterEncoder::CompressBand(const RasterPage &page, const Band &band, std::vector<uint8_t> &out) const
+{
+    uint32_t bpp = OutputBytesPerPixel(page);
+    size_t lineBytes = static_cast<size_t>(page.width) * bpp;
+    std::vector<uint8_t> current(lineBytes), next(lineBytes);
+
+    uint32_t end = band.firstRow + band.rows;
+    uint32_t row = band.firstRow;
+    ConvertRow(page, row, current.data());
+
+    while (row < end)
+    {
+        uint32_t repeat = 1;
+        while (row + repeat < end && repeat < kMaxLineRepeat)
+        {
+            ConvertRow(page, row + repeat, next.data());
+            if (next != current)
+                break;
+            repeat++;
+        }
+
+        out.push_back(static_cast<uint8_t>(repeat - 1));
+        PackLine(current.data(), page.width, bpp, out);
+
+        row += repeat;
+        if (row < end)
+            current.swap(next);
+    }
+}
+
+void RasterEncoder::WriteFileHeader(size_t pageCount, std::vector<uint8_t> &out) const
+{
+    if (options.format == RasterFormat::Urf)
+    {
+        out.assign(12, 0);
+        PutString(out, 0, "UNIRAST");
+        PutBE32(out, 8, static_cast<uint32_t>(pageCount));
+    }
+    else
+    {
+        out.assign({'R', 'a', 'S', '2'});
+    }
+}
+
+void RasterEncoder::WritePageHeader(const RasterPage &page, size_t pageCount, std::vector<uint8_t> &out) const
+{
+    uint32_t bpp = OutputBytesPerPixel(page);
+    uint32_t dpi = options.resolution;
+
+    if (options.format == RasterFormat::Urf)
+    {
+        out.assign(kUrfPageHeaderSize, 0);
+        out[0] = static_cast<uint8_t>(bpp * 8);
+        out[1] = bpp == 1 ? 0 : 1; // sGray / sRGB
+        out[2] = 1;                // simplex
+        out[3] = 4;                // qualidade normal
+        PutBE32(out, 12, page.width);
+        PutBE32(out, 16, page.height);
+        PutBE32(out, 20, dpi);
+        return;
+    }
+
+    // Offsets do cabeçalho de página PWG 5102.4 (big-endian, 1796 bytes).
+    out.assign(kPwgHeaderSize, 0);
+    PutString(out, 0, "PwgRaster");
+    PutBE32(out, 276, dpi);
+    PutBE32(out, 280, dpi);
+    PutBE32(out, 340, 1);
+    PutBE32(out, 352, static_cast<uint32_t>(page.width * 72ULL / dpi));
+    PutBE32(out, 356, static_cast<uint32_t>(page.height * 72ULL / dpi));
+    PutBE32(out, 372, page.width);
+    PutBE32(out, 376, page.height);
+    PutBE32(out, 384, 8);
+    PutBE32(out, 388, bpp * 8);
+    PutBE32(out, 392, page.width * bpp);
+    PutBE32(out, 400, bpp == 1 ? 18 : 19); // sgray / srgb
+    PutBE32(out, 420, bpp);
+    PutBE32(out, 452, static_cast<uint32_t>(pageCount));
+    PutBE32(out, 456, 1);
+    PutBE32(out, 460, 1);
+}
+
+bool RasterEncoder::Encode(const std::vector<RasterPage> &pages, const ChunkWriter &write)
+{
+    std::vector<Band> bands;
+    for (size_t p = 0; p < pages.size(); p++)
+    {
+        for (uint32_t row = 0; row < pages[p].height; row += options.bandHeight)
+        {
+            bands.push_back({p, row, std::min(options.bandHeight, pages[p].height - row)});
+        }
+    }
+
+    unsigned threadCount = options.threads ? options.threads : std::thread::hardware_concurrency();
+    threadCount = std::max(1u, std::min<unsigned>(threadCount, static_cast<unsigned>(bands.size())));
+    // Limita as bandas comprimidas à espera de escrita para não segurar o documento inteiro.
+    size_t maxAhead = static_cast<size_t>(threadCount) * 4;
+
+    std::vector<std::vector<uint8_t>> results(bands.size());
+    std::vector<char> ready(bands.size(), 0);
+    std::mutex mutex;
+    std::condition_variable changed;
+    size_t nextBand = 0;
+    size_t written = 0;
+    bool cancelled = false;
+
+    auto compress = [&]()
+    {
+        for (;;)
+        {
+            size_t index;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                changed.wait(lock, [&]
+                             { return cancelled || nextBand >= bands.size() || nextBand < written + maxAhead; });
+                if (cancelled || nextBand >= bands.size())
+                    return;
+                index = nextBand++;
+            }
+
+            std::vector<uint8_t> out;
+            CompressBand(pages[bands[index].page], bands[index], out);
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                results[index].swap(out);
+                ready[index] = 1;
+            }
+            changed.notify_all();
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (unsigned i = 0; i < threadCount; i++)
+        threads.emplace_back(compress);
+
+    std::vector<uint8_t> header;
+    WriteFileHeader(pages.size(), header);
+    bool ok = write(header.data(), header.size());
+
+    for (size_t i = 0; ok && i < bands.size(); i++)
+    {
+        if (bands[i].firstRow == 0)
+        {
+            WritePageHeader(pages[bands[i].page], pages.size(), header);
+            ok = write(header.data(), header.size());
+            if (!ok)
+                break;
+        }
+
+        std::vector<uint8_t> band;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            changed.wait(lock, [&]
+                         { return ready[i] != 0; });
+            band.swap(results[i]);
+            written = i + 1;
+        }
+        changed.notify_all();
+
+        ok = write(band.data(), band.size());
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        cancelled = true;
+    }
+    changed.notify_all();
+    for (auto &thread : threads)
+        thread.join();
+
+    return ok;
+}
@@ -0,0 +1,64 @@
+#ifndef RASTER_ENCODER_H
+#define RASTER_ENCODER_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "printer_interface.h"
+
+enum class RasterFormat
+{
+    Pwg,
+    Urf
+};
+
+struct RasterPage
+{
+    uint32_t width;
+    uint32_t height;
+    uint32_t channels; // 1 = cinza, 3 = RGB, 4 = RGBA
+    // Não é dono dos pixels: quem monta a página mantém o buffer vivo até o
+    // fim da codificação (no addon, o Buffer do JS fica referenciado).
+    const uint8_t *pixels;
+};
+
+struct RasterOptions
+{
+    RasterFormat format = RasterFormat::Pwg;
+    uint32_t resolution = 300;
+    bool grayscale = false;
+    uint32_t bandHeight = 64;
+    unsigned threads = 0; // 0 = std::thread::hardware_concurrency()
+};
+
+// Codifica páginas em PWG Raster ("image/pwg-raster") ou Apple URF
+// ("image/urf") com a compressão PackBits por linha das duas especificações.
+// As bandas de cada página são comprimidas em paralelo e entregues ao writer
+// em ordem, assim que ficam prontas.
+class RasterEncoder
+{
+public:
+    explicit RasterEncoder(const RasterOptions &options);
+
+    bool Encode(const std::vector<RasterPage> &pages, const ChunkWriter &write);
+
+    static const char *MimeType(RasterFormat format);
+
+private:
+    struct Band
+    {
+        size_t page;
+        uint32_t firstRow;
+        uint32_t rows;
+    };
+
+    uint32_t OutputBytesPerPixel(const RasterPage &page) const;
+    void ConvertRow(const RasterPage &page, uint32_t row, uint8_t *out) const;
+    void CompressBand(const RasterPage &page, const Band &band, std::vector<uint8_t> &out) const;
+    void WriteFileHeader(size_t pageCount, std::vector<uint8_t> &out) const;
+    void WritePageHeader(const RasterPage &page, size_t pageCount, std::vector<uint8_t> &out) const;
+
+    RasterOptions options;
+};
+
+#endif
@@ -0,0 +1,211 @@
+#include "trace.h"
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+
+#ifdef _WIN32
+#include <process.h>
+#define getpid _getpid
+#else
+#include <unistd.h>
+#endif
+
+namespace
+{
+    struct TraceEvent
+    {
+        const char *name;
+        char printer[64];
+        uint64_t jobId;
+        int64_t startUs;
+        int64_t durationUs;
+        uint32_t threadId;
+    };
+
+    // sequence guarda índice + 1 quando o evento está completo e 0 enquanto
+    // está sendo escrito; o leitor descarta slots que mudaram durante a cópia.
+    struct TraceSlot
+    {
+        std::atomic<uint64_t> sequence;
+        TraceEvent event;
+    };
+
+    std::mutex allocationMutex;
+    std::atomic<TraceSlot *> slots(nullptr);
+    std::atomic<uint64_t> head(0);
+    std::atomic<uint64_t> sessionStart(0);
+    std::atomic<uint64_t> nextJobId(0);
+    std::atomic<uint32_t> nextThreadId(0);
+
+    thread_local uint64_t currentJobId = 0;
+    thread_local const std::string *currentPrinter = nullptr;
+
+    uint32_t CurrentThreadId()
+    {
+        thread_local uint32_t id = ++nextThreadId;
+        return id;
+    }
+
+    int64_t ToMicroseconds(Trace::Clock::time_point time)
+    {
+        return std::chrono::duration_cast<std::chrono::microseconds>(time.time_since_epoch()).count();
+    }
+
+    void AppendEscaped(std::string &out, const char *value)
+    {
+        for (const char *p = value; *p; p++)
+        {
+            unsigned char c = static_cast<unsigned char>(*p);
+            if (c == '"' || c == '\\')
+            {
+                out += '\\';
+                out += *p;
+            }
+            else if (c < 0x20)
+            {
+                char escaped[8];
+                snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                out += escaped;
+            }
+            else
+            {
+                out += *p;
+            }
+        }
+    }
+}
+
+std::atomic<bool> Trace::enabled(false);
+
+void Trace::SetEnabled(bool value)
+{
+    if (value)
+    {
+        // O buffer é alocado na primeira vez e nunca liberado, para que um
+        // escritor atrasado nunca toque memória já devolvida.
+        std::lock_guard<std::mutex> lock(allocationMutex);
+        if (!slots.load(std::memory_order_acquire))
+        {
+            TraceSlot *buffer = new TraceSlot[kCapacity];
+            for (size_t i = 0; i < kCapacity; i++)
+                buffer[i].sequence.store(0, std::memory_order_relaxed);
+            slots.store(buffer, std::memory_order_release);
+        }
+        sessionStart.store(head.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+    enabled.store(value, std::memory_order_release);
+}
+
+uint64_t Trace::NextJobId()
+{
+    if (!IsEnabled())
+        return 0;
+    return ++nextJobId;
+}
+
+void Trace::Record(const char *name, const std::string &printer, uint64_t jobId,
+                   Clock::time_point start, Clock::time_point end)
+{
+    // Spans abertos antes de setTracing(false) terminam sem gravar nada.
+    if (!IsEnabled())
+        return;
+    TraceSlot *buffer = slots.load(std::memory_order_acquire);
+    if (!buffer)
+        return;
+
+    uint64_t index = head.fetch_add(1, std::memory_order_relaxed);
+    TraceSlot &slot = buffer[index & (kCapacity - 1)];
+
+    slot.sequence.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    TraceEvent &event = slot.event;
+    event.name = name;
+    size_t length = printer.size() < sizeof(event.printer) - 1 ? printer.size() : sizeof(event.printer) - 1;
+    memcpy(event.printer, printer.data(), length);
+    event.printer[length] = '\0';
+    event.jobId = jobId;
+    event.startUs = ToMicroseconds(start);
+    event.durationUs = ToMicroseconds(end) - event.startUs;
+    event.threadId = CurrentThreadId();
+
+    slot.sequence.store(index + 1, std::memory_order_release);
+}
+
+std::string Trace::Dump()
+{
+    std::string out = "{\"traceEvents\":[";
+
+    TraceSlot *buffer = slots.load(std::memory_order_acquire);
+    if (buffer)
+    {
+        uint64_t end = head.load(std::memory_order_acquire);
+        uint64_t begin = sessionStart.load(std::memory_order_relaxed);
+        if (end - begin > kCapacity)
+            begin = end - kCapacity;
+
+        int pid = static_cast<int>(getpid());
+        bool first = true;
+        char line[192];
+
+        for (uint64_t index = begin; index < end; index++)
+        {
+            TraceSlot &slot = buffer[index & (kCapacity - 1)];
+            if (slot.sequence.load(std::memory_order_acquire) != index + 1)
+                continue;
+
+            TraceEvent event = slot.event;
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.sequence.load(std::memory_order_relaxed) != index + 1)
+                continue;
+
+            if (!first)
+                out += ',';
+            first = false;
+
+            snprintf(line, sizeof(line),
+                     "{\"name\":\"%s\",\"cat\":\"print\",\"ph\":\"X\",\"ts\":%lld,\"dur\":%lld,\"pid\":%d,\"tid\":%u,\"args\":{",
+                     event.name, static_cast<long long>(event.startUs), static_cast<long long>(event.durationUs),
+                     pid, event.threadId);
+            out += line;
+
+            snprintf(line, sizeof(line), "\"jobId\":%llu", static_cast<unsigned long long>(event.jobId));
+            out += line;
+            if (event.printer[0])
+            {
+                out += ",\"printer\":\"";
+                AppendEscaped(out, event.printer);
+                out += '"';
+            }
+            out += "}}";
+        }
+    }
+
+    out += "],\"displayTimeUnit\":\"ms\"}";
+    return out;
+}
+
+TraceJobScope::TraceJobScope(uint64_t jobId, const std::string &printer)
+    : previousJobId(currentJobId),
+      previousPrinter(currentPrinter)
+{
+    currentJobId = jobId;
+    currentPrinter = &printer;
+}
+
+TraceJobScope::~TraceJobScope()
+{
+    currentJobId = previousJobId;
+    currentPrinter = previousPrinter;
+}
+
+uint64_t TraceJobScope::CurrentJobId()
+{
+    return currentJobId;
+}
+
+const std::string &TraceJobScope::CurrentPrinter()
+{
+    static const std::string none;
+    return currentPrinter ? *currentPrinter : none;
+}
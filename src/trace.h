@@ -0,0 +1,82 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <cstdint>
+
+// Rastreamento opcional das fases do pipeline de impressão, exportado no
+// formato trace-event do Chrome (chrome://tracing, Perfetto).
+//
+// Os eventos vão para um buffer circular de tamanho fixo, sem locks: cada
+// escritor reserva um slot com um fetch_add e publica o evento com um número
+// de sequência. Quando o buffer enche, os eventos mais antigos são
+// sobrescritos. Desligado, cada ponto de rastreamento custa uma leitura
+// atômica relaxada.
+class Trace
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr size_t kCapacity = 1 << 16;
+
+    static bool IsEnabled() { return enabled.load(std::memory_order_relaxed); }
+    // Ao ligar, descarta os eventos de uma sessão anterior.
+    static void SetEnabled(bool value);
+
+    // Identificador de correlação de um trabalho; 0 quando o rastreamento está desligado.
+    static uint64_t NextJobId();
+
+    static void Record(const char *name, const std::string &printer, uint64_t jobId,
+                       Clock::time_point start, Clock::time_point end);
+
+    // JSON no formato {"traceEvents": [...]}.
+    static std::string Dump();
+
+private:
+    static std::atomic<bool> enabled;
+};
+
+// Trabalho em andamento na thread atual. As fases registradas dentro dos
+// backends (cupsCreateJob, WritePrinter...) herdam o id e a impressora.
+class TraceJobScope
+{
+public:
+    TraceJobScope(uint64_t jobId, const std::string &printer);
+    ~TraceJobScope();
+
+    static uint64_t CurrentJobId();
+    static const std::string &CurrentPrinter();
+
+private:
+    uint64_t previousJobId;
+    const std::string *previousPrinter;
+};
+
+// Registra o intervalo entre a construção e a destruição como uma fase do
+// trabalho atual da thread.
+class TraceSpan
+{
+public:
+    explicit TraceSpan(const char *name)
+        : name(name), active(Trace::IsEnabled())
+    {
+        if (active)
+            start = Trace::Clock::now();
+    }
+
+    ~TraceSpan()
+    {
+        if (active)
+            Trace::Record(name, TraceJobScope::CurrentPrinter(), TraceJobScope::CurrentJobId(),
+                          start, Trace::Clock::now());
+    }
+
+private:
+    const char *name;
+    bool active;
+    Trace::Clock::time_point start;
+};
+
+#endif
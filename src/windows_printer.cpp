@@ -1,4 +1,5 @@
 #include "windows_printer.h"
+#include "trace.h"
 #include <vector>
 
 std::string WindowsPrinter::GetPrinterStatus(DWORD status)
@@ -46,6 +47,44 @@ std::string WindowsPrinter::GetPrinterStatus(DWORD status)
     return "ready";
 }
 
+PrinterState WindowsPrinter::GetPrinterState(DWORD status)
+{
+    // PRINTER_STATUS_* não traz severidade; usa a que o IPP dá à condição equivalente.
+    static const struct
+    {
+        DWORD status;
+        uint32_t reason;
+        PrinterStateSeverity severity;
+    } kMapping[] = {
+        {PRINTER_STATUS_PAUSED, REASON_PAUSED, printer_state::kPausedSeverity},
+        {PRINTER_STATUS_ERROR, REASON_ERROR, SEVERITY_ERROR},
+        {PRINTER_STATUS_PENDING_DELETION, REASON_SHUTDOWN, printer_state::kPausedSeverity},
+        {PRINTER_STATUS_PAPER_JAM, REASON_MEDIA_JAM, SEVERITY_ERROR},
+        {PRINTER_STATUS_PAPER_OUT, REASON_MEDIA_EMPTY, SEVERITY_ERROR},
+        {PRINTER_STATUS_MANUAL_FEED, REASON_MEDIA_NEEDED, SEVERITY_WARNING},
+        {PRINTER_STATUS_PAPER_PROBLEM, REASON_MEDIA_NEEDED, SEVERITY_ERROR},
+        {PRINTER_STATUS_OFFLINE, REASON_OFFLINE, SEVERITY_ERROR},
+        {PRINTER_STATUS_OUTPUT_BIN_FULL, REASON_OUTPUT_AREA_FULL, SEVERITY_ERROR},
+        {PRINTER_STATUS_NOT_AVAILABLE, REASON_OFFLINE, SEVERITY_ERROR},
+        {PRINTER_STATUS_SERVER_UNKNOWN, REASON_CONNECTING_TO_DEVICE, SEVERITY_WARNING},
+        {PRINTER_STATUS_WARMING_UP, REASON_WARMING_UP, SEVERITY_REPORT},
+        {PRINTER_STATUS_TONER_LOW, REASON_TONER_LOW, SEVERITY_WARNING},
+        {PRINTER_STATUS_NO_TONER, REASON_TONER_EMPTY, SEVERITY_ERROR},
+        {PRINTER_STATUS_PAGE_PUNT, REASON_OTHER, SEVERITY_WARNING},
+        {PRINTER_STATUS_USER_INTERVENTION, REASON_USER_INTERVENTION, SEVERITY_ERROR},
+        {PRINTER_STATUS_OUT_OF_MEMORY, REASON_RESOURCE_UNAVAILABLE, SEVERITY_ERROR},
+        {PRINTER_STATUS_DOOR_OPEN, REASON_DOOR_OPEN, SEVERITY_ERROR},
+    };
+
+    PrinterState state;
+    for (const auto &entry : kMapping)
+    {
+        if (status & entry.status)
+            PrinterStateDecoder::Add(entry.reason, entry.severity, state);
+    }
+    return state;
+}
+
 std::wstring WindowsPrinter::Utf8ToWide(const std::string &str)
 {
     std::wstring wstr;
@@ -72,8 +111,17 @@ std::string WindowsPrinter::WideToUtf8(LPWSTR wstr)
     return std::string(buffer.data());
 }
 
+bool WindowsPrinter::IsAvailable()
+{
+    // winspool.drv é carregada sob demanda (delay-load) e sempre existe no Windows.
+    return true;
+}
+
 PrinterInfo WindowsPrinter::GetPrinterDetails(const std::string &printerName, bool isDefault)
 {
+    TraceJobScope traceJob(TraceJobScope::CurrentJobId(), printerName);
+    TraceSpan span("GetPrinterDetails");
+
     PrinterInfo info;
     info.name = printerName;
     info.isDefault = isDefault;
@@ -92,6 +140,9 @@ PrinterInfo WindowsPrinter::GetPrinterDetails(const std::string &printerName, bo
             {
                 PRINTER_INFO_2W *pInfo = (PRINTER_INFO_2W *)buffer.data();
                 info.status = GetPrinterStatus(pInfo->Status);
+                PrinterState state = GetPrinterState(pInfo->Status);
+                info.stateReasons = state.reasons;
+                info.stateSeverity = state.severity;
 
                 if (pInfo->pLocation)
                     info.details["location"] = WideToUtf8(pInfo->pLocation);
@@ -155,15 +206,25 @@ PrinterInfo WindowsPrinter::GetSystemDefaultPrinter()
     return PrinterInfo();
 }
 
-bool WindowsPrinter::PrintDirect(const std::string &printerName, const std::vector<uint8_t> &data, const std::string &dataType)
+bool WindowsPrinter::PrintDirect(const std::string &printerName, const std::vector<uint8_t> &data, const std::string &dataType,
+                                 DocumentCompression compression)
+{
+    return PrintStream(printerName, dataType, [&data](const ChunkWriter &write)
+                       { return write(data.data(), data.size()); }) == PrintOutcome::Printed;
+}
+
+PrintOutcome WindowsPrinter::PrintStream(const std::string &printerName, const std::string &dataType, const DocumentProducer &produce,
+                                         DocumentCompression compression)
 {
     HANDLE hPrinter;
     std::wstring wPrinterName = Utf8ToWide(printerName);
-    std::wstring wDataType = Utf8ToWide(dataType);
 
-    if (!OpenPrinterW((LPWSTR)wPrinterName.c_str(), &hPrinter, NULL))
     {
-        return false;
+        TraceSpan span("OpenPrinter");
+        if (!OpenPrinterW((LPWSTR)wPrinterName.c_str(), &hPrinter, NULL))
+        {
+            return PrintOutcome::NotSent;
+        }
     }
 
     DOC_INFO_1W docInfo;
@@ -171,26 +232,48 @@ bool WindowsPrinter::PrintDirect(const std::string &printerName, const std::vect
     docInfo.pDocName = docName;
     docInfo.pOutputFile = NULL;
     docInfo.pDatatype = (LPWSTR)L"RAW"; // Force RAW data type
-    
-    if (StartDocPrinterW(hPrinter, 1, (LPBYTE)&docInfo))
+
+    DWORD docId;
     {
-        if (StartPagePrinter(hPrinter))
-        {
+        TraceSpan span("StartDocPrinter");
+        docId = StartDocPrinterW(hPrinter, 1, (LPBYTE)&docInfo);
+    }
+    if (!docId)
+    {
+        ClosePrinter(hPrinter);
+        return PrintOutcome::NotSent;
+    }
+
+    if (!StartPagePrinter(hPrinter))
+    {
+        AbortPrinter(hPrinter);
+        ClosePrinter(hPrinter);
+        return PrintOutcome::NotSent;
+    }
+
+    bool written;
+    {
+        TraceSpan span("write");
+        written = produce([hPrinter](const uint8_t *chunk, size_t size)
+                          {
             DWORD bytesWritten;
-            void *buffer = const_cast<void *>(static_cast<const void *>(data.data()));
-            if (WritePrinter(hPrinter, buffer, static_cast<DWORD>(data.size()), &bytesWritten))
-            {
-                EndPagePrinter(hPrinter);
-                EndDocPrinter(hPrinter);
-                ClosePrinter(hPrinter);
-                return true;
-            }
-        }
-        EndDocPrinter(hPrinter);
+            void *buffer = const_cast<void *>(static_cast<const void *>(chunk));
+            return WritePrinter(hPrinter, buffer, static_cast<DWORD>(size), &bytesWritten) != 0; });
+    }
+    if (!written)
+    {
+        // EndDocPrinter enviaria o trabalho pela metade; AbortPrinter o apaga.
+        // O spooler pode já ter repassado parte dos bytes à impressora.
+        AbortPrinter(hPrinter);
+        ClosePrinter(hPrinter);
+        return PrintOutcome::Failed;
     }
 
+    TraceSpan span("EndDocPrinter");
+    EndPagePrinter(hPrinter);
+    bool ended = EndDocPrinter(hPrinter) != 0;
     ClosePrinter(hPrinter);
-    return false;
+    return ended ? PrintOutcome::Printed : PrintOutcome::Failed;
 }
 
 PrinterInfo WindowsPrinter::GetStatusPrinter(const std::string &printerName)
@@ -21,15 +21,20 @@ class WindowsPrinter : public PrinterInterface
 {
 private:
     std::string GetPrinterStatus(DWORD status);
+    PrinterState GetPrinterState(DWORD status);
     std::wstring Utf8ToWide(const std::string &str);
     std::string WideToUtf8(LPWSTR wstr);
 
 public:
+    virtual bool IsAvailable() override;
     virtual PrinterInfo GetPrinterDetails(const std::string &printerName, bool isDefault = false) override;
     virtual std::vector<PrinterInfo> GetPrinters() override;
     virtual PrinterInfo GetSystemDefaultPrinter() override;
-    virtual bool PrintDirect(const std::string &printerName, const std::vector<uint8_t> &data, const std::string &dataType) override;
+    virtual bool PrintDirect(const std::string &printerName, const std::vector<uint8_t> &data, const std::string &dataType,
+                             DocumentCompression compression = DocumentCompression::None) override;
     virtual PrinterInfo GetStatusPrinter(const std::string &printerName) override;
+    virtual PrintOutcome PrintStream(const std::string &printerName, const std::string &dataType, const DocumentProducer &produce,
+                                     DocumentCompression compression = DocumentCompression::None) override;
 };
 
 #endif
\ No newline at end of file